@@ -0,0 +1,65 @@
+// 连接超时管理：每个EventLoop一个时间轮，按连接所处的阶段（读请求头、读请求体、keep-alive空闲）限制时长
+// 阶段切换时只修改连接上下文里的截止刻度，时间轮条目到期时再检查，没有真正超时的重新放回，每个请求的开销是O(1)
+// 读请求头和读请求体的截止时间只在进入该阶段时设置一次，慢速发送数据（slowloris）不会延长超时
+// 只能在所属EventLoop的线程中使用
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/TcpConnection.h>
+
+#include "HttpContext.h"
+#include "../utils/TimingWheel.h"
+
+namespace http
+{
+
+    struct TimeoutConfig
+    {
+        int headerSeconds = 10;    // 从连接建立或收到请求的第一个字节起，读完请求头的时限
+        int bodySeconds = 30;      // 读完请求体的时限
+        int keepAliveSeconds = 60; // 两个请求之间允许空闲的时长
+        // 以上时间 <= 0 表示该阶段不限时
+
+        static TimeoutConfig defaultConfig()
+        {
+            return TimeoutConfig();
+        }
+    };
+
+    class ConnectionWheel : muduo::noncopyable
+    {
+    public:
+        ConnectionWheel(muduo::net::EventLoop *loop, const TimeoutConfig &config);
+
+        // 开始每秒推进时间轮
+        void start();
+
+        // 连接进入新的阶段，按该阶段的时限重新设置截止刻度
+        void enter(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, HttpContext::TimeoutPhase phase);
+
+        size_t size() const { return wheel_.size(); }
+        // 可以在其他线程中读取
+        uint64_t timedOut() const { return timedOut_.load(std::memory_order_relaxed); }
+
+    private:
+        // 条目记录连接和它在时间轮中的到期刻度，刻度与上下文中记录的不一致说明条目已经被新的替代
+        using Entry = std::pair<std::weak_ptr<muduo::net::TcpConnection>, uint64_t>;
+
+        void onTick();
+        uint64_t ticksFor(HttpContext::TimeoutPhase phase) const;
+        void schedule(const std::weak_ptr<muduo::net::TcpConnection> &conn, HttpContext *context, uint64_t deadline);
+
+    private:
+        muduo::net::EventLoop *loop_;
+        TimeoutConfig          config_;
+        TimingWheel<Entry>     wheel_;
+        std::atomic<uint64_t>  timedOut_; // 因超时被关闭的连接数
+    };
+
+} // namespace http
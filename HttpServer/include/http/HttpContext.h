@@ -4,6 +4,7 @@
 #include <iostream>
 #include <muduo/net/TcpServer.h>
 #include "HttpRequest.h"
+#include "HttpResponse.h"
 
 namespace http{
 
@@ -17,15 +18,24 @@ public:
         kGotAll, //解析完成
     };
 
-    HttpContext():state_(kExpectRequestLine){};
+    // 超时阶段：空闲(keep-alive)、读请求头、读请求体，各阶段的超时时间不同
+    enum TimeoutPhase{
+        kIdle,
+        kReadingHeader,
+        kReadingBody,
+    };
+
+    HttpContext():state_(kExpectRequestLine), timeoutPhase_(kIdle), deadlineTick_(0), scheduledTick_(0), awaitingResponse_(false){};
 
     bool parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime);
     bool gotAll() const{ return state_ == kGotAll;}
+    bool expectBody() const{ return state_ == kExpectBody;}
+    // 已经收到了请求的一部分
+    bool inRequest() const{ return state_ != kExpectRequestLine;}
 
     void reset(){
         state_ = kExpectRequestLine;
-        HttpRequest dummyData;
-        request_.swap(dummyData);
+        request_.reset();
     }
 
     const HttpRequest& request() const{
@@ -36,11 +46,42 @@ public:
         return request_;
     } 
 
+    // 连接上复用的响应对象，异步响应还没发送完时仍被sender持有，此时需要另建一个
+    std::shared_ptr<HttpResponse>& response(){
+        return response_;
+    }
+
+    // 连接上复用的输出缓冲区，发送后保留容量
+    muduo::net::Buffer* outputBuffer(){
+        return &outputBuf_;
+    }
+
+
+    // 以下由所在EventLoop的ConnectionWheel维护，reset()不会清除
+    TimeoutPhase timeoutPhase() const{ return timeoutPhase_;}
+    uint64_t deadlineTick() const{ return deadlineTick_;}
+    void setDeadline(TimeoutPhase phase, uint64_t tick){
+        timeoutPhase_ = phase;
+        deadlineTick_ = tick;
+    }
+    // 连接在时间轮中最早的有效条目所在的刻度，0表示不在时间轮中
+    uint64_t scheduledTick() const{ return scheduledTick_;}
+    void setScheduledTick(uint64_t tick){ scheduledTick_ = tick;}
+
+    // 当前请求的响应还没有发出；异步响应等待期间连接暂停读取，reset()不会清除
+    bool awaitingResponse() const{ return awaitingResponse_;}
+    void setAwaitingResponse(bool awaiting){ awaitingResponse_ = awaiting;}
 
 private:
     bool processRequestLine(const char* begin,const char* end);
     HttpRequestParseState state_;
     HttpRequest request_;
+    std::shared_ptr<HttpResponse> response_;
+    muduo::net::Buffer outputBuf_;
+    TimeoutPhase timeoutPhase_;
+    uint64_t deadlineTick_;
+    uint64_t scheduledTick_;
+    bool awaitingResponse_;
 };
 
 
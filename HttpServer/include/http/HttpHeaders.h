@@ -0,0 +1,93 @@
+// Http头部表：常用头部放在按枚举编号的固定槽位里，其他头部放在顺序存储的溢出区
+// 头部名按大小写不敏感比较；常用头部由(长度, 首字符, 尾字符)构成的完美哈希直接定位到槽位
+// clear()只清空内容不释放内存，连接上的请求对象复用时查找和写入都不需要分配
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace http
+{
+
+    class HttpHeaders
+    {
+    public:
+        // 常用头部，新增时需要保证kKnownNames在完美哈希下没有冲突（构造哈希表时会检查）
+        enum Known
+        {
+            kHost,
+            kCookie,
+            kContentType,
+            kContentLength,
+            kConnection,
+            kAccept,
+            kOrigin,
+            kSetCookie,
+            kKnownCount
+        };
+
+        static const char *const kKnownNames[kKnownCount];
+
+        // 头部名对应的常用头部编号，不是常用头部返回-1
+        static int knownIndex(const char *name, size_t len);
+
+        void set(const char *name, size_t nameLen, const char *value, size_t valueLen);
+        void set(const std::string &name, const std::string &value)
+        {
+            set(name.data(), name.size(), value.data(), value.size());
+        }
+        void set(Known key, const std::string &value)
+        {
+            known_[key].assign(value);
+            present_ |= 1u << key;
+        }
+
+        // 不存在时返回空字符串的引用
+        const std::string &get(Known key) const
+        {
+            return (present_ >> key) & 1u ? known_[key] : empty();
+        }
+        const std::string &get(const std::string &name) const;
+
+        bool has(Known key) const { return (present_ >> key) & 1u; }
+        bool has(const std::string &name) const;
+
+        size_t size() const;
+        void clear();
+        void swap(HttpHeaders &that);
+
+        // 依次访问所有头部：先是常用头部，再按插入顺序访问溢出区
+        template <typename F>
+        void forEach(F &&fn) const
+        {
+            for (int i = 0; i < kKnownCount; i++)
+            {
+                if ((present_ >> i) & 1u)
+                    fn(kKnownNames[i], known_[i]);
+            }
+            for (size_t i = 0; i < extraSize_; i++)
+            {
+                fn(extra_[i].name, extra_[i].value);
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            std::string value;
+        };
+
+        static const std::string &empty();
+        const Entry *findExtra(const char *name, size_t len) const;
+
+    private:
+        std::array<std::string, kKnownCount> known_;
+        uint32_t                             present_ = 0;   // 第i位表示第i个常用头部存在
+        std::vector<Entry>                   extra_;         // 溢出区，只增不减，复用其中的字符串
+        size_t                               extraSize_ = 0; // 溢出区中有效的项数
+    };
+
+} // namespace http
@@ -6,6 +6,8 @@
 #include <unordered_map>
 #include <muduo/base/Timestamp.h>
 
+#include "HttpHeaders.h"
+
 namespace http
 {
 
@@ -25,6 +27,10 @@ namespace http
 
         HttpRequest() : method_(kInvalid), version_("Unknown") {};
 
+        // 客户端地址在连接建立时设置一次，reset()不会清除
+        void setPeerIp(const std::string &ip) { peerIp_ = ip; }
+        const std::string &peerIp() const { return peerIp_; }
+
         void setReceiveTime(muduo::Timestamp t);
         muduo::Timestamp receiveTime() const { return receiveTime_; }
 
@@ -32,28 +38,38 @@ namespace http
         Method method() const { return method_; }
 
         void setPath(const char *start, const char *end);
-        std::string path() const { return path_; }
+        const std::string &path() const { return path_; }
 
+        // 以下查询接口返回内部存储的引用，不存在时返回空字符串的引用，引用在reset()之前有效
         void setPathParameters(const std::string &key, const std::string &value);
-        std::string getPathParameters(const std::string &key) const;
+        const std::string &getPathParameters(const std::string &key) const;
+        void clearPathParameters() { pathParameters_.clear(); }
 
         void setQueryParameters(const char *start, const char *end);
-        std::string getQueryParameters(const std::string &key) const;
+        const std::string &getQueryParameters(const std::string &key) const;
 
-        void setVersion(std::string v)
+        void setVersion(const std::string &v)
         {
             version_ = v;
         }
 
-        std::string getVersion() const
+        const std::string &getVersion() const
         {
             return version_;
         }
 
         void addHeader(const char *start, const char *colon, const char *end);
-        std::string getHeader(const std::string &field) const;
+        // 头部名大小写不敏感，常用头部建议直接传枚举
+        const std::string &getHeader(const std::string &field) const
+        {
+            return headers_.get(field);
+        }
+        const std::string &getHeader(HttpHeaders::Known field) const
+        {
+            return headers_.get(field);
+        }
 
-        const std::map<std::string, std::string> &headers() const
+        const HttpHeaders &headers() const
         {
             return headers_;
         }
@@ -67,7 +83,7 @@ namespace http
             }
         }
 
-        std::string getBody() const
+        const std::string &getBody() const
         {
             return content_;
         }
@@ -77,6 +93,8 @@ namespace http
         uint64_t contentLength() const { return contentLength_; }
 
         void swap(HttpRequest &that);
+        // 清空内容以便解析同一连接上的下一个请求，保留已分配的内存
+        void reset();
 
     private:
         Method method_;                                                // 请求方法
@@ -85,9 +103,10 @@ namespace http
         std::unordered_map<std::string, std::string> pathParameters_;  // 路径参数
         std::unordered_map<std::string, std::string> queryParameters_; // 查询参数
         muduo::Timestamp receiveTime_;                                 // 接收时间
-        std::map<std::string, std::string> headers_;                   // 请求头
+        HttpHeaders headers_;                                          // 请求头
         std::string content_;                                          // 请求体
         uint64_t contentLength_{0};                                    // 请求体长度
+        std::string peerIp_;                                           // 客户端IP
     };
 
 } // namespace http
\ No newline at end of file
@@ -1,8 +1,12 @@
 // 对Http响应报文的封装
 #pragma once
 
+#include <functional>
+
 #include <muduo/net/TcpServer.h>
 
+#include "HttpHeaders.h"
+
 namespace http
 {
 
@@ -20,10 +24,57 @@ namespace http
             k403Forbidden = 403,
             k404NotFound = 404,
             k409Conflict = 409,
+            k429TooManyRequests = 429,
             k500InternalServerError = 500,
+            k503ServiceUnavailable = 503,
         };
 
-        HttpResponse(bool close = true) : statusCode_(kUnknown), closeConnection_(close) {}
+        // 异步响应：处理函数先返回，稍后在任意线程调用sender，传入填写响应的函数
+        // 填写函数会在连接所在的EventLoop线程中执行，之后再经过后置中间件并发送
+        using AsyncFiller = std::function<void(HttpResponse *)>;
+        using AsyncSender = std::function<void(AsyncFiller)>;
+
+        HttpResponse(bool close = true) : statusCode_(kUnknown), closeConnection_(close), async_(false) {}
+
+        // 由HttpServer设置，用于创建当前响应的sender
+        void setAsyncStarter(std::function<AsyncSender()> starter)
+        {
+            asyncStarter_ = std::move(starter);
+        }
+
+        // 把当前响应转为异步，调用后处理函数不应再直接修改该响应
+        // 不是由HttpServer创建的响应没有异步能力，返回的sender会直接填写当前对象
+        AsyncSender startAsync()
+        {
+            if (!asyncStarter_)
+            {
+                return [this](AsyncFiller fill) { fill(this); };
+            }
+            async_ = true;
+            return asyncStarter_();
+        }
+
+        bool isAsync() const
+        {
+            return async_;
+        }
+
+        bool hasAsyncStarter() const
+        {
+            return static_cast<bool>(asyncStarter_);
+        }
+
+        // 清空内容以便连接上的下一个请求复用，保留头部表和响应体已分配的内存，asyncStarter保持不变
+        void reset(bool close)
+        {
+            httpVersion_.clear();
+            statusCode_ = kUnknown;
+            statusMessage_.clear();
+            closeConnection_ = close;
+            headers_.clear();
+            body_.clear();
+            async_ = false;
+        }
 
         void setVersion(std::string version)
         {
@@ -55,17 +106,21 @@ namespace http
 
         void setContentType(const std::string &contentType)
         {
-            addHeader("Content-Type", contentType);
+            addHeader(HttpHeaders::kContentType, contentType);
         }
 
         void setContentLength(uint64_t length)
         {
-            addHeader("Content-Length", std::to_string(length));
+            addHeader(HttpHeaders::kContentLength, std::to_string(length));
         }
 
         void addHeader(const std::string &key, const std::string &value)
         {
-            headers_[key] = value;
+            headers_.set(key, value);
+        }
+        void addHeader(HttpHeaders::Known key, const std::string &value)
+        {
+            headers_.set(key, value);
         }
 
         void setBody(const std::string &body)
@@ -74,6 +129,12 @@ namespace http
             // body_ += "\0";
         }
 
+        // 直接在响应体上追加内容（例如配合JsonWriter），写完后需要自行设置Content-Length
+        std::string *mutableBody()
+        {
+            return &body_;
+        }
+
         void setStatusLine(const std::string &version,
                            HttpStatusCode statusCode,
                            const std::string &statusMessage);
@@ -87,9 +148,11 @@ namespace http
         HttpStatusCode statusCode_;
         std::string statusMessage_;
         bool closeConnection_;
-        std::map<std::string, std::string> headers_;
+        HttpHeaders headers_;
         std::string body_;
         bool isFile_;
+        bool async_;
+        std::function<AsyncSender()> asyncStarter_;
     };
 
 } // namespace http
\ No newline at end of file
@@ -7,23 +7,34 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <muduo/net/TcpServer.h>
 #include <muduo/net/EventLoop.h>
+#include <muduo/net/EventLoopThreadPool.h>
 #include <muduo/base/Logging.h>
 
+#include "ConnectionWheel.h"
 #include "HttpContext.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "Listener.h"
+#include "ListenerHandoff.h"
+#include "ServerLimits.h"
 #include "../router/Router.h"
 #include "../session/SessionManager.h"
 #include "../middleware/MiddlewareChain.h"
+#include "../middleware/StaticMiddlewareChain.h"
 #include "../middleware/cors/CorsMiddleware.h"
+#include "../middleware/ratelimit/RateLimitMiddleware.h"
 #include "../ssl/SslConnection.h"
 #include "../ssl/SslContext.h"
 
@@ -38,23 +49,60 @@ namespace http
 
     public:
         using HttpCallback = std::function<void(const http::HttpRequest &, http::HttpResponse *)>;
+        // 请求级回调拿到的是连接上下文中的请求对象本身，中间件和路由直接在上面修改，不再复制
+        using RequestCallback = std::function<void(http::HttpRequest &, http::HttpResponse *)>;
 
+        // 监听套接字和连接由HttpServer自己管理（见Listener），option只决定监听套接字是否设置SO_REUSEPORT
         HttpServer(int port, const std::string &name, bool useSSL = false,
                    muduo::net::TcpServer::Option option = muduo::net::TcpServer::kNoReusePort);
 
         void setThreadNum(int numThreads)
         {
-            server_.setThreadNum(numThreads);
+            numThreads_ = numThreads;
         }
 
+        // 多监听模式：每个IO线程各自打开一个SO_REUSEPORT监听套接字，由内核把新连接分散到各个线程，
+        // 各线程自己accept、自己处理，不再经过主循环；主循环同样监听并处理一部分连接
+        // 需要构造时传入kReusePort，并在start()之前设置
+        void setReusePortListeners(bool on)
+        {
+            reusePortListeners_ = on;
+        }
+
+        // 把每个IO线程（多监听模式下包括主循环）依次绑定到一个CPU核上，需要在start()之前设置
+        void setCpuAffinity(bool on)
+        {
+            cpuAffinity_ = on;
+        }
+
+        // 运行主循环，stop()之后等连接都关闭才返回
         void start();
 
-        muduo::net::EventLoop *getLoop() const
+        // 优雅退出：停止accept，空闲的keep-alive连接立即关闭，处理中的请求应答后关闭连接
+        // 超过drainTimeout仍未关闭的连接被强制关闭，之后start()返回。可以在任意线程调用
+        void stop();
+
+        // 只设置一个标志，可以在信号处理函数中调用，主循环定期检查后调用stop()
+        static void requestStop();
+
+        void setDrainTimeout(double seconds)
+        {
+            drainSeconds_ = seconds;
+        }
+
+        // 监听套接字交接用的Unix域套接字路径：启动时先从该路径上的旧进程接管监听套接字，
+        // 之后在该路径上等待下一个新进程，交接完成后本进程优雅退出。需要在start()之前设置
+        void setHandoffPath(const std::string &path)
+        {
+            handoffPath_ = path;
+        }
+
+        muduo::net::EventLoop *getLoop()
         {
-            return server_.getLoop();
+            return &mainLoop_;
         }
 
-        void setHttpCallback(const HttpCallback &cb)
+        void setHttpCallback(const RequestCallback &cb)
         {
             httpCallback_ = cb;
         }
@@ -117,24 +165,108 @@ namespace http
 
         void setSslConfig(const ssl::SslConfig &config);
 
+        // 连接的读请求头、读请求体和keep-alive空闲超时，需要在start()之前设置
+        void setTimeouts(const TimeoutConfig &config)
+        {
+            timeouts_ = config;
+        }
+
+        // 连接数和每个EventLoop处理中请求数的上限，需要在start()之前设置
+        void setLimits(const ServerLimits &limits)
+        {
+            limits_ = limits;
+        }
+
+        // 当前的连接数、处理中请求数和拒绝、超时计数，可以在任意线程调用
+        ServerStats stats() const;
+
     private:
-        void initialize();
+        // 每个EventLoop各自的状态，保存在EventLoop的上下文中，只在所属线程修改，计数可以被其他线程读取
+        struct LoopState
+        {
+            LoopState(muduo::net::EventLoop *loop, const TimeoutConfig &timeouts)
+                : loop(loop), wheel(loop, timeouts), inFlight(0), rejectedRequests(0) {}
+
+            muduo::net::EventLoop *loop;
+            std::unordered_set<muduo::net::TcpConnectionPtr> connections; // 本EventLoop上的连接，只在所属线程访问
+            ConnectionWheel       wheel;
+            std::atomic<int>      inFlight;         // 处理中（包括等待异步应答）的请求数
+            std::atomic<uint64_t> rejectedRequests;
+        };
+        using LoopStatePtr = std::shared_ptr<LoopState>;
+
+        // 创建监听套接字（优先使用从旧进程接管的），多监听模式下每个EventLoop一个
+        void startListeners(std::vector<int> inherited);
+        // 监听的EventLoop上accept到新连接，创建TcpConnection交给目标EventLoop
+        void newConnection(Listener *listener, int sockfd, const muduo::net::InetAddress &peerAddr);
+        void removeConnection(const muduo::net::TcpConnectionPtr &conn);
+        std::vector<int> listenerFds() const;
+
+        void stopInLoop();
+        // 没有请求在处理的连接直接关闭
+        void closeIfIdle(const muduo::net::TcpConnectionPtr &conn);
+        // 主循环定期检查：收到退出信号时开始退出，退出过程中检查连接是否都已关闭
+        void onHousekeeping();
+        // 主循环退出后，在各自的线程中销毁监听套接字，再结束IO线程
+        void shutdownLoops();
+        // 在所属线程中销毁该EventLoop上剩下的连接
+        void destroyConnections(LoopState *state);
+
+        // 在每个IO线程中创建该EventLoop的状态（连接超时时间轮和计数）
+        void onThreadInit(muduo::net::EventLoop *loop);
+        static LoopState *loopStateOf(muduo::net::EventLoop *loop);
+        // 按解析进度更新连接所处的超时阶段
+        void updateTimeout(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, const muduo::net::Buffer *buf);
 
         void onConnection(const muduo::net::TcpConnectionPtr &conn);
         void onMessage(const muduo::net::TcpConnectionPtr &conn, muduo::net::Buffer *buf, muduo::Timestamp receiveTime);
-        void onRequest(const muduo::net::TcpConnectionPtr &, const HttpRequest &);
-        void handleRequest(const HttpRequest &req, HttpResponse *resp);
+        void onRequest(const muduo::net::TcpConnectionPtr &, HttpContext *context);
+        // 取出连接上可复用的响应对象，必要时新建
+        std::shared_ptr<HttpResponse> acquireResponse(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, bool close);
+        void sendResponse(const muduo::net::TcpConnectionPtr &conn, HttpResponse &response);
+        // 异步响应发出后恢复读取，并处理暂停期间留在缓冲区中的请求
+        void resumeRead(const muduo::net::TcpConnectionPtr &conn, const HttpResponse &response);
+        // 创建异步响应的sender，sender把响应的填写、后置中间件和发送都投递回连接所在的EventLoop
+        // sender持有请求的处理中计数，应答发送完、sender销毁时才减去
+        HttpResponse::AsyncSender makeAsyncSender(const std::weak_ptr<muduo::net::TcpConnection> &weakConn,
+                                                  const std::shared_ptr<HttpResponse> &response);
+        void handleRequest(HttpRequest &req, HttpResponse *resp);
 
     private:
+        std::string name_;
         muduo::net::InetAddress listenAddr_; // 监听地址
-        muduo::net::TcpServer server_;
-        muduo::net::EventLoop mainLoop_; // 主循环
-        HttpCallback httpCallback_;
+        muduo::net::EventLoop mainLoop_; // 主循环，必须先于threadPool_构造
+        std::unique_ptr<muduo::net::EventLoopThreadPool> threadPool_;
+        muduo::net::TcpServer::Option option_;
+        int numThreads_;
+        bool reusePortListeners_;
+        bool cpuAffinity_;
+        std::atomic<int> nextCpu_{0};
+        std::vector<std::unique_ptr<Listener>> listeners_; // 各自在所属EventLoop中accept
+        bool dispatch_;                                   // 只有主循环监听时，把连接轮流分给IO线程
+        std::atomic<int> nextConnId_{1};
+
+        std::string handoffPath_;
+        std::unique_ptr<ListenerHandoff> handoff_;
+        std::atomic<bool> draining_{false};
+        double drainSeconds_;
+        muduo::Timestamp drainDeadline_;
+        bool forcedClose_;
+        std::mutex sendersMutex_; // 工作线程投递异步应答与结束IO线程互斥
+        bool loopsStopped_;       // 由sendersMutex_保护
+        RequestCallback httpCallback_;
         router::Router router_;
         std::unique_ptr<session::SessionManager> sessionManager_;
         middleware::MiddlewareChain middlewareChain_;
         std::unique_ptr<ssl::SslContext> sslCtx_;
         bool useSSL_;
+        TimeoutConfig timeouts_;
+        ServerLimits limits_;
+
+        std::atomic<int> connections_{0};
+        std::atomic<uint64_t> rejectedConnections_{0};
+        mutable std::mutex loopsMutex_;
+        std::vector<LoopStatePtr> loops_; // 所有EventLoop的状态，用于汇总计数
 
         std::map<muduo::net::TcpConnectionPtr, std::unique_ptr<ssl::SslConnection>> sslConns_;
     };
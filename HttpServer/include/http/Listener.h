@@ -0,0 +1,51 @@
+// 监听套接字：在所属的EventLoop中accept新连接，交给回调创建TcpConnection
+// 与muduo的Acceptor作用相同，区别是可以接管已有的监听套接字（从旧进程交接过来的），也可以随时停止监听
+// 除了createSocket，所有接口都只能在所属EventLoop的线程中调用，也必须在该线程中析构
+#pragma once
+
+#include <functional>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/net/InetAddress.h>
+
+namespace http
+{
+
+    class Listener : muduo::noncopyable
+    {
+    public:
+        using NewConnectionCallback = std::function<void(int sockfd, const muduo::net::InetAddress &peerAddr)>;
+
+        // 新建一个绑定到addr的非阻塞监听套接字，失败返回-1
+        static int createSocket(const muduo::net::InetAddress &addr, bool reusePort);
+
+        // 接管fd，析构时关闭
+        Listener(muduo::net::EventLoop *loop, int fd);
+        ~Listener();
+
+        void setNewConnectionCallback(const NewConnectionCallback &cb) { newConnectionCallback_ = cb; }
+
+        void listen();
+        // 停止accept并关闭监听套接字，已经交给其他进程的套接字在那边仍然有效
+        void stop();
+
+        int fd() const { return fd_; }
+        muduo::net::EventLoop *loop() const { return loop_; }
+        bool listening() const { return listening_; }
+
+    private:
+        void handleRead(muduo::Timestamp receiveTime);
+
+    private:
+        muduo::net::EventLoop *loop_;
+        int                    fd_;
+        muduo::net::Channel    channel_;
+        int                    idleFd_; // 文件描述符耗尽时用来接受并立即关闭连接，避免监听套接字一直可读
+        bool                   listening_;
+        NewConnectionCallback  newConnectionCallback_;
+    };
+
+} // namespace http
@@ -0,0 +1,51 @@
+// 监听套接字交接，用于不中断服务的重启
+// 旧进程在一个Unix域套接字上等待；新进程启动时连接它，通过SCM_RIGHTS收到旧进程的监听套接字，
+// 回复确认后旧进程停止accept并开始优雅退出。交接期间内核中排队的连接由新进程继续accept，不会丢失
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include <muduo/net/Channel.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+    class ListenerHandoff : muduo::noncopyable
+    {
+    public:
+        using FdsProvider = std::function<std::vector<int>()>;
+        using HandedOffCallback = std::function<void()>;
+
+        // 新进程调用：向path上的旧进程索取监听套接字，没有旧进程或者交接失败时返回空
+        static std::vector<int> fetch(const std::string &path);
+
+        // 旧进程：在所属EventLoop中等待新进程连接，必须在该线程中析构
+        ListenerHandoff(muduo::net::EventLoop *loop, const std::string &path);
+        ~ListenerHandoff();
+
+        // 开始等待，provider返回要交出去的监听套接字，对方确认收到后调用onHandedOff
+        bool listen(const FdsProvider &provider, const HandedOffCallback &onHandedOff);
+
+    private:
+        void handleRead(muduo::Timestamp receiveTime);
+
+        static bool sendFds(int sock, const std::vector<int> &fds);
+        static std::vector<int> recvFds(int sock);
+
+    private:
+        muduo::net::EventLoop *loop_;
+        std::string            path_;
+        int                    fd_;
+        std::unique_ptr<muduo::net::Channel> channel_; // fd_创建成功后才有
+        bool                   handedOff_;
+        FdsProvider            provider_;
+        HandedOffCallback      onHandedOff_;
+    };
+
+} // namespace http
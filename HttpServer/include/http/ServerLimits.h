@@ -0,0 +1,33 @@
+// 服务器的过载保护配置和运行计数
+// 连接数达到上限后，新连接收到一个预先生成的503后立即关闭，不创建上下文、不解析请求
+// 每个EventLoop上同时处理中（包括等待异步应答）的请求数达到上限后，新请求直接返回503
+#pragma once
+
+#include <cstdint>
+
+namespace http
+{
+
+    struct ServerLimits
+    {
+        int maxConnections = 10000;   // 整个服务器的最大连接数，<= 0表示不限制
+        int maxInFlightPerLoop = 512; // 每个EventLoop同时处理中的请求数上限，<= 0表示不限制
+
+        static ServerLimits defaultConfig()
+        {
+            return ServerLimits();
+        }
+    };
+
+    // 某一时刻的计数快照，供运维查看和调整上限
+    struct ServerStats
+    {
+        int      connections = 0;         // 当前连接数
+        int      inFlight = 0;            // 所有EventLoop上处理中的请求数
+        int      loops = 0;               // IO线程（EventLoop）数
+        uint64_t rejectedConnections = 0; // 因连接数上限被拒绝的连接
+        uint64_t rejectedRequests = 0;    // 因处理中请求数上限被拒绝的请求
+        uint64_t timedOut = 0;            // 因超时被关闭的连接
+    };
+
+} // namespace http
@@ -7,10 +7,16 @@ namespace http{
     namespace middleware{
         class Middleware{
         public:
+            //请求前处理的结果
+            enum Action{
+                kContinue, //继续执行后面的中间件和路由
+                kRespond   //中间件已经在response中填好了响应，直接返回给客户端
+            };
+
             virtual ~Middleware() = default;
 
-            //请求前处理
-            virtual void before(HttpRequest& request) = 0; 
+            //请求前处理，需要直接应答时（例如cors预检请求）填写response并返回kRespond
+            virtual Action before(HttpRequest& request, HttpResponse& response) = 0; 
 
             //响应后处理
             virtual void after(HttpResponse& response) = 0;
@@ -7,11 +7,15 @@
 namespace http{
     namespace middleware{
 
+        // 运行时组合的中间件链，中间件类型在编译期已知时可以使用StaticMiddlewareChain
         class MiddlewareChain{
         public:
             void addMiddleware(std::shared_ptr<Middleware> middleware);
-            void processBefore(HttpRequest &request);
+            //返回false表示某个中间件已经填写好响应，此时该中间件外层的after已经执行过，不必再调用processAfter
+            bool processBefore(HttpRequest &request, HttpResponse &response);
             void processAfter(HttpResponse &response);
+        private:
+            void afterOne(Middleware &middleware, HttpResponse &response);
         private:
             std::vector<std::shared_ptr<Middleware>> middlewares_;
         };
@@ -0,0 +1,93 @@
+// 编译期组合的中间件流水线：中间件类型在模板参数中确定，按值保存在tuple里
+// before/after都是对具体类型的直接调用，编译器可以内联，不需要逐个虚函数调用
+// 自身也是一个Middleware，可以整体加入HttpServer的MiddlewareChain，整条流水线每个阶段只有一次虚函数调用
+// 中间件类型只需提供与Middleware相同签名的before/after，建议声明为final
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <muduo/base/Logging.h>
+
+#include "Middleware.h"
+
+namespace http
+{
+    namespace middleware
+    {
+
+        template <typename... Ms>
+        class StaticMiddlewareChain final : public Middleware
+        {
+            static_assert(sizeof...(Ms) > 0, "StaticMiddlewareChain needs at least one middleware");
+
+        public:
+            StaticMiddlewareChain() = default;
+            // 每个参数用来就地构造对应位置的中间件（可以是中间件本身或者它的配置），中间件不需要可拷贝
+            template <typename... Args, typename = std::enable_if_t<sizeof...(Args) == sizeof...(Ms) && (sizeof...(Args) > 0)>>
+            explicit StaticMiddlewareChain(Args &&...args) : middlewares_(std::forward<Args>(args)...) {}
+
+            // 按前后顺序执行before，某个中间件直接应答时，只对它外层的中间件执行after，然后返回kRespond
+            Action before(HttpRequest &request, HttpResponse &response) override
+            {
+                return beforeFrom<0>(request, response);
+            }
+
+            // 栈式执行模式（洋葱模型），after的顺序与before相反
+            // 每个中间件单独捕获异常，一个中间件出错不影响其他中间件
+            void after(HttpResponse &response) override
+            {
+                afterUpTo<sizeof...(Ms)>(response);
+            }
+
+            template <typename M>
+            M &get()
+            {
+                return std::get<M>(middlewares_);
+            }
+
+        private:
+            template <size_t I>
+            Action beforeFrom(HttpRequest &request, HttpResponse &response)
+            {
+                if constexpr (I == sizeof...(Ms))
+                {
+                    return kContinue;
+                }
+                else
+                {
+                    if (std::get<I>(middlewares_).before(request, response) == kRespond)
+                    {
+                        afterUpTo<I>(response);
+                        return kRespond;
+                    }
+                    return beforeFrom<I + 1>(request, response);
+                }
+            }
+
+            // 倒序执行前N个中间件的after
+            template <size_t N>
+            void afterUpTo(HttpResponse &response)
+            {
+                if constexpr (N > 0)
+                {
+                    try
+                    {
+                        std::get<N - 1>(middlewares_).after(response);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        LOG_ERROR << "Error in middleware after processing: " << e.what();
+                    }
+                    afterUpTo<N - 1>(response);
+                }
+            }
+
+        private:
+            std::tuple<Ms...> middlewares_;
+        };
+
+    } // namespace middleware
+} // namespace http
@@ -9,15 +9,15 @@ namespace http
 {
     namespace middleware
     {
-        class CorsMiddleware : public Middleware
+        class CorsMiddleware final : public Middleware
         {
         public:
             explicit CorsMiddleware(const CorsConfig &config = CorsConfig::defaultConfig());
 
-            void before(HttpRequest &request) override;
+            Action before(HttpRequest &request, HttpResponse &response) override;
             void after(HttpResponse &response) override;
 
-            std::string join(const std::vector<std::string> &strings, const std::string &delimiter);
+            static std::string join(const std::vector<std::string> &strings, const std::string &delimiter);
 
         private:
             bool isOriginAllowed(const std::string &origin) const;
@@ -26,6 +26,12 @@ namespace http
 
         private:
             CorsConfig config_;
+            // 以下响应头的值在构造时由config_生成一次，每个响应直接复用
+            bool        allowAllOrigins_;
+            std::string defaultOrigin_;  // 普通响应的Access-Control-Allow-Origin，为空表示不添加
+            std::string allowMethods_;
+            std::string allowHeaders_;
+            std::string maxAge_;
         };
 
     } // namespace middleware
@@ -0,0 +1,46 @@
+// 限流配置：按路由设置令牌桶的速率和容量，以及限流的对象（客户端IP或者会话）
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace http
+{
+    namespace middleware
+    {
+        struct RateLimitRule
+        {
+            enum KeyType
+            {
+                kPeerIp,  // 按客户端IP限流
+                kSession  // 按会话id限流，cookie中没有服务端认可的会话时退化为按IP
+            };
+
+            std::string path;              // 精确匹配的请求路径
+            double      ratePerSecond = 0; // 每秒补充的令牌数，<= 0表示不限流
+            double      burst = 0;         // 桶容量，允许的突发请求数
+            KeyType     keyType = kPeerIp;
+        };
+
+        struct RateLimitConfig
+        {
+            std::vector<RateLimitRule> rules;       // 按路由的规则
+            RateLimitRule              defaultRule; // 没有匹配到路由时使用，ratePerSecond <= 0表示不限流
+            int                        idleSeconds = 120; // 桶超过这么久没有被访问就回收
+            size_t                     maxBuckets = 65536; // 桶数上限，平均分到各分片，分片满后新的客户端按规则共用一个溢出桶
+            // 判断cookie中的会话id是否真实存在；cookie由客户端控制，为空时按会话限流的规则一律按IP限流
+            std::function<bool(const std::string &sessionId)> sessionValidator;
+
+            static RateLimitConfig defaultConfig()
+            {
+                RateLimitConfig config;
+                config.defaultRule.ratePerSecond = 50;
+                config.defaultRule.burst = 100;
+                return config;
+            }
+        };
+
+    } // namespace middleware
+} // namespace http
@@ -0,0 +1,84 @@
+// 令牌桶限流中间件：按(路由规则, 客户端IP或会话id)分配令牌桶，令牌不足时直接返回429和Retry-After
+// 桶按key的哈希分片存放，分片锁只在查找和创建桶时持有，扣减令牌是对桶状态的无锁CAS
+// 空闲的桶用时间轮惰性回收：访问只更新桶的最后活跃刻度，时间轮到期时再检查是否真的空闲
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../Middleware.h"
+#include "../../http/HttpRequest.h"
+#include "../../http/HttpResponse.h"
+#include "../../utils/TimingWheel.h"
+#include "RateLimitConfig.h"
+#include "TokenBucket.h"
+
+namespace http
+{
+    namespace middleware
+    {
+        class RateLimitMiddleware final : public Middleware
+        {
+        public:
+            explicit RateLimitMiddleware(const RateLimitConfig &config = RateLimitConfig::defaultConfig());
+
+            Action before(HttpRequest &request, HttpResponse &response) override;
+            void after(HttpResponse &) override {}
+
+            // 运行状态
+            size_t bucketCount() const;
+            uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+        private:
+            static const size_t kShardCount = 16;
+            static const int64_t kTickMs = 1000;
+
+            // 令牌桶的时间相对于中间件创建时刻
+            struct Bucket
+            {
+                TokenBucket           tokens;
+                std::atomic<uint64_t> lastSeenTick;
+
+                Bucket(uint64_t capacityMilli, int64_t nowMs, uint64_t tick) : tokens(capacityMilli, nowMs), lastSeenTick(tick) {}
+            };
+            using BucketPtr = std::shared_ptr<Bucket>;
+
+            struct Shard
+            {
+                std::mutex                                 mutex;
+                std::unordered_map<uint64_t, BucketPtr>    buckets;
+            };
+
+            const RateLimitRule *matchRule(const std::string &path) const;
+            // 计算桶的key，规则编号参与哈希，不同路由的桶互不影响
+            uint64_t bucketKey(size_t ruleIndex, const RateLimitRule &rule, const HttpRequest &request) const;
+            // 分片中的桶数达到上限时不再为新key建桶，改用规则的溢出桶
+            BucketPtr findOrCreate(uint64_t key, uint64_t overflowKey, const RateLimitRule &rule, int64_t nowMs);
+            // 按需推进时间轮，回收空闲的桶
+            void advanceWheel(int64_t nowMs);
+
+            int64_t elapsedMs() const;
+            Shard &shardFor(uint64_t key) { return shards_[key % kShardCount]; }
+
+        private:
+            RateLimitConfig                    config_;
+            std::unordered_map<std::string, size_t> ruleIndex_; // path -> config_.rules中的下标
+            std::string                        tooManyBody_; // 预先生成的429响应体
+            int64_t                            startMs_;
+            std::array<Shard, kShardCount>     shards_;
+
+            std::mutex                         wheelMutex_;
+            TimingWheel<uint64_t>              wheel_;       // 桶的key，按空闲超时排列
+            std::atomic<int64_t>               nextTickMs_;
+            std::atomic<uint64_t>              currentTick_;
+            std::atomic<uint64_t>              rejected_;
+            size_t                             maxBucketsPerShard_;
+        };
+
+    } // namespace middleware
+} // namespace http
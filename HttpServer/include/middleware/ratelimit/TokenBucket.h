@@ -0,0 +1,66 @@
+// 令牌桶：令牌数按千分之一个令牌计，和上次补充的时间(毫秒)一起打包在一个64位原子变量里，取令牌是无锁CAS
+// 高32位: 令牌数 * 1000  低32位: 上次补充的时间，相对于调用方选定的起点
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace http
+{
+    namespace middleware
+    {
+        class TokenBucket
+        {
+        public:
+            // 新桶是满的
+            TokenBucket(uint64_t capacityMilli, int64_t nowMs)
+                : state_(pack(capacityMilli, static_cast<uint32_t>(nowMs)))
+            {
+            }
+
+            // 取一个令牌，成功返回0，否则返回还需要等待的毫秒数
+            // 不同线程读到的nowMs可能比桶里记录的时间早（读时间和CAS之间被其他线程抢先），
+            // 此时按没有经过时间处理，记录的时间也不会往回退
+            int64_t consume(uint64_t capacityMilli, double ratePerSecond, int64_t nowMs)
+            {
+                const uint32_t now32 = static_cast<uint32_t>(nowMs);
+                uint64_t old = state_.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    uint64_t tokens = old >> 32;
+                    uint32_t last = static_cast<uint32_t>(old);
+                    // 按有符号差值计算，32位时间回绕时仍然正确；空闲的桶早已被回收，不会出现超过24天的间隔
+                    int32_t diff = static_cast<int32_t>(now32 - last);
+                    uint32_t newLast = diff > 0 ? now32 : last;
+                    // ratePerSecond个令牌/秒 = ratePerSecond个千分之一令牌/毫秒
+                    double refill = diff > 0 ? static_cast<double>(diff) * ratePerSecond : 0;
+                    tokens = std::min<uint64_t>(capacityMilli, tokens + static_cast<uint64_t>(std::min(refill, 4.0e9)));
+                    if (tokens < 1000)
+                    {
+                        return std::max<int64_t>(1, static_cast<int64_t>(std::ceil((1000 - tokens) / ratePerSecond)));
+                    }
+                    if (state_.compare_exchange_weak(old, pack(tokens - 1000, newLast),
+                                                     std::memory_order_relaxed, std::memory_order_relaxed))
+                    {
+                        return 0;
+                    }
+                }
+            }
+
+            // 当前剩余的令牌数（千分之一个令牌），不计算尚未补充的部分
+            uint64_t tokensMilli() const { return state_.load(std::memory_order_relaxed) >> 32; }
+
+        private:
+            static uint64_t pack(uint64_t milliTokens, uint32_t timeMs)
+            {
+                return milliTokens << 32 | timeMs;
+            }
+
+        private:
+            std::atomic<uint64_t> state_;
+        };
+
+    } // namespace middleware
+} // namespace http
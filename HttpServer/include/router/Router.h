@@ -70,8 +70,8 @@ namespace http
                 regexCallbacks_.emplace_back(method, pathRegex, callback);
             }
 
-            // 处理请求
-            bool route(const HttpRequest &req, HttpResponse *resp);
+            // 处理请求，动态路由匹配时把路径参数直接写入req
+            bool route(HttpRequest &req, HttpResponse *resp);
 
         private:
             std::regex convertToRegex(const std::string &pathPattern)
@@ -84,6 +84,7 @@ namespace http
             // 提取路径参数
             void extractPathParameters(const std::smatch &match, HttpRequest &request)
             {
+                request.clearPathParameters();
                 for (size_t i = 1; i < match.size(); i++)
                 {
                     request.setPathParameters("param" + std::to_string(i), match[i].str());
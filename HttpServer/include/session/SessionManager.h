@@ -19,6 +19,12 @@ namespace http
             // 从请求中获取或者创建对话
             std::shared_ptr<Session> getSession(const HttpRequest &req, HttpResponse *resp);
 
+            // 会话是否存在且没有过期，不创建新会话
+            bool hasSession(const std::string& sessionId)
+            {
+                return storage_->load(sessionId) != nullptr;
+            }
+
             // 销毁会话
             void destroySession(const std::string& sessionId);
 
@@ -0,0 +1,184 @@
+// 流式JSON写入器：直接把紧凑格式的JSON追加到调用方提供的字符串（通常是响应体）后面
+// 不构建中间的json树，不做格式化缩进，除了目标字符串扩容外没有其他内存分配
+// 嵌套深度用一个64位掩码记录每层是否已经写过元素，最多支持64层
+#pragma once
+
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string* out) : out_(out), depth_(0), hasElement_(0), afterKey_(false) {}
+
+    JsonWriter& beginObject() { return open('{'); }
+    JsonWriter& endObject() { return close('}'); }
+    JsonWriter& beginArray() { return open('['); }
+    JsonWriter& endArray() { return close(']'); }
+
+    JsonWriter& key(const char* name, size_t len)
+    {
+        separator();
+        writeString(name, len);
+        out_->push_back(':');
+        afterKey_ = true;
+        return *this;
+    }
+    JsonWriter& key(const std::string& name) { return key(name.data(), name.size()); }
+    JsonWriter& key(const char* name) { return key(name, std::strlen(name)); }
+
+    JsonWriter& value(const char* str, size_t len)
+    {
+        separator();
+        writeString(str, len);
+        return *this;
+    }
+    JsonWriter& value(const std::string& str) { return value(str.data(), str.size()); }
+    JsonWriter& value(const char* str) { return value(str, std::strlen(str)); }
+
+    JsonWriter& value(bool b)
+    {
+        separator();
+        out_->append(b ? "true" : "false");
+        return *this;
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JsonWriter&>::type
+    value(T n)
+    {
+        separator();
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), n);
+        out_->append(buf, result.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& value(double d)
+    {
+        separator();
+        // JSON没有NaN和无穷大
+        if (!std::isfinite(d))
+        {
+            out_->append("null");
+            return *this;
+        }
+        char buf[32];
+        auto result = std::to_chars(buf, buf + sizeof(buf), d);
+        out_->append(buf, result.ptr - buf);
+        return *this;
+    }
+
+    JsonWriter& null()
+    {
+        separator();
+        out_->append("null");
+        return *this;
+    }
+
+    // 原样写入一段已经渲染好的JSON值
+    JsonWriter& raw(const char* json, size_t len)
+    {
+        separator();
+        out_->append(json, len);
+        return *this;
+    }
+    JsonWriter& raw(const std::string& json) { return raw(json.data(), json.size()); }
+
+    // 写入一个键值对
+    template <typename K, typename V>
+    JsonWriter& field(const K& name, const V& v)
+    {
+        key(name);
+        return value(v);
+    }
+
+    // 渲染 {"status":"error","message":message}，用于预先生成固定的错误响应体
+    static std::string errorBody(const std::string& message)
+    {
+        std::string body;
+        JsonWriter writer(&body);
+        writer.beginObject()
+              .field("status", "error")
+              .field("message", message)
+              .endObject();
+        return body;
+    }
+
+private:
+    // 写值之前补上逗号：键后面的值不需要，同一层的第二个及以后的元素需要
+    void separator()
+    {
+        if (afterKey_)
+        {
+            afterKey_ = false;
+            return;
+        }
+        uint64_t bit = uint64_t(1) << depth_;
+        if (hasElement_ & bit)
+            out_->push_back(',');
+        hasElement_ |= bit;
+    }
+
+    JsonWriter& open(char c)
+    {
+        separator();
+        out_->push_back(c);
+        assert(depth_ < 63);
+        depth_++;
+        hasElement_ &= ~(uint64_t(1) << depth_);
+        return *this;
+    }
+
+    JsonWriter& close(char c)
+    {
+        assert(depth_ > 0);
+        depth_--;
+        out_->push_back(c);
+        return *this;
+    }
+
+    void writeString(const char* s, size_t len)
+    {
+        static const char kHex[] = "0123456789abcdef";
+        out_->push_back('"');
+        size_t start = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            // 不需要转义的部分整段追加
+            out_->append(s + start, i - start);
+            start = i + 1;
+            switch (c)
+            {
+            case '"': out_->append("\\\""); break;
+            case '\\': out_->append("\\\\"); break;
+            case '\n': out_->append("\\n"); break;
+            case '\r': out_->append("\\r"); break;
+            case '\t': out_->append("\\t"); break;
+            case '\b': out_->append("\\b"); break;
+            case '\f': out_->append("\\f"); break;
+            default:
+                {
+                    char esc[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F]};
+                    out_->append(esc, sizeof(esc));
+                }
+            }
+        }
+        out_->append(s + start, len - start);
+        out_->push_back('"');
+    }
+
+private:
+    std::string* out_;
+    int          depth_;
+    uint64_t     hasElement_; // 第i位表示第i层是否已经写过元素
+    bool         afterKey_;
+};
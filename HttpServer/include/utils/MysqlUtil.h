@@ -1,6 +1,10 @@
 //
 #pragma once 
 #include "db/DbConnectionPool.h"
+#include "db/DbExecutor.h"
+#include "db/ResultCursor.h"
+#include <future>
+#include <memory>
 #include <string>
 
 namespace http{
@@ -12,9 +16,57 @@ namespace http{
                         size_t poolSize = 10){
 
             http::db::DbConnectionPool::getInstance().init(host,user,password,database,poolSize);
+            http::db::DbExecutor::getInstance().start(static_cast<int>(poolSize));
+        }
+
+        //可伸缩的连接池：按需在minSize和maxSize之间增减连接，获取连接有超时
+        static void init(const std::string& host,const std::string& user,
+                        const std::string& password, const std::string& database,
+                        const http::db::DbPoolConfig& config){
+
+            http::db::DbConnectionPool::getInstance().init(host,user,password,database,config);
+            //数据库线程数和连接数上限一致，线程再多也只会在连接池上排队
+            http::db::DbExecutor::getInstance().start(static_cast<int>(config.maxSize));
+        }
+
+        //在数据库线程池中执行work，返回future
+        template<typename Work>
+        static auto submit(Work&& work) -> std::future<decltype(work())>{
+            using Result = decltype(work());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Work>(work));
+            std::future<Result> result = task->get_future();
+            http::db::DbExecutor::getInstance().run([task]() { (*task)(); });
+            return result;
+        }
+
+        //在数据库线程池中执行work，完成后在数据库线程上调用done(std::future<R>)，work抛出的异常通过future.get()重新抛出
+        //需要回到连接所在的EventLoop发送响应时，在done里调用HttpResponse::startAsync()返回的sender
+        template<typename Work, typename Done>
+        static void runAsync(Work&& work, Done&& done){
+            using Result = decltype(work());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Work>(work));
+            auto callback = std::make_shared<typename std::decay<Done>::type>(std::forward<Done>(done));
+            http::db::DbExecutor::getInstance().run([task, callback]() {
+                (*task)();
+                (*callback)(task->get_future());
+            });
+        }
+
+        //连接池运行状态，包括等待队列长度和等待时间分布
+        static http::db::DbPoolStats poolStats(){
+            return http::db::DbConnectionPool::getInstance().stats();
+        }
+
+        //流式查询，返回的游标持有连接直到析构，逐行读取，可以配合DbColumns<T>直接解码成结构体
+        template<typename... Args>
+        http::db::ResultCursor cursor(const std::string& sql,Args&&... args){
+            auto conn = http::db::DbConnectionPool::getInstance().getConnection();
+            auto query = conn->streamQuery(sql,std::forward<Args>(args)...);
+            return http::db::ResultCursor(std::move(conn),std::move(query));
         }
 
         //模板函数，从连接池中获取一个对象conn，并调用对象的响应方法
+        //注意：返回时连接已经归还连接池，结果集需要调用者自己delete，新代码请使用query()或cursor()
         template<typename... Args>
         sql::ResultSet* executeQuery(const std::string& sql,Args&&... args){
             auto conn = http::db::DbConnectionPool::getInstance().getConnection();
@@ -22,11 +74,26 @@ namespace http{
         }
         //std::forward<Args>(args)... 是标准写法，保持每个参数原来的引用类型（左值还是右值）展开成一个个参数，传给底层数据库执行函数
     
+        //使用连接上缓存的预处理语句查询，结果集交给fn在归还连接前处理完，返回fn的返回值
+        template<typename Fn, typename... Args>
+        auto query(const std::string& sql, Fn&& fn, Args&&... args)
+            -> decltype(fn(std::declval<sql::ResultSet&>())){
+            auto conn = http::db::DbConnectionPool::getInstance().getConnection();
+            return conn->query(sql,std::forward<Fn>(fn),std::forward<Args>(args)...);
+        }
+
         template<typename... Args>
         int executeUpdate(const std::string& sql,Args&&... args){
             auto conn = http::db::DbConnectionPool::getInstance().getConnection();
             return conn->executeUpdate(sql,std::forward<Args>(args)...);
         }
+
+        //执行INSERT，返回自增主键，没有插入行时返回0
+        template<typename... Args>
+        uint64_t executeInsert(const std::string& sql,Args&&... args){
+            auto conn = http::db::DbConnectionPool::getInstance().getConnection();
+            return conn->executeInsert(sql,std::forward<Args>(args)...);
+        }
     };
 
 }// namespace http
@@ -0,0 +1,67 @@
+// 时间轮：把到期时间相近的条目放进同一个槽，每过一个刻度处理一个槽
+// 加入和推进都是O(1)（按条目均摊），适合大量条目、精度要求不高的超时管理
+// 推荐配合"惰性续期"使用：条目被访问时只更新自己的最后活跃时间，到期时在回调里检查，
+// 还没有真正超时的条目重新放回时间轮，这样访问路径上不需要操作时间轮
+// 本身不加锁，需要由调用方保证在同一个线程中使用，或者在外部加锁
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class TimingWheel
+{
+public:
+    // slots为槽的个数，决定了能表示的最长超时（slots - 1个刻度）
+    explicit TimingWheel(size_t slots)
+        : slots_(slots < 2 ? 2 : slots)
+        , cursor_(0)
+        , now_(0)
+        , size_(0)
+    {
+    }
+
+    // 当前刻度，每次tick加一
+    uint64_t now() const { return now_; }
+    size_t size() const { return size_; }
+    size_t maxTicks() const { return slots_.size() - 1; }
+
+    // ticks个刻度之后到期，超出时间轮范围的按最大值处理，至少为1
+    void schedule(T item, size_t ticks)
+    {
+        if (ticks < 1)
+            ticks = 1;
+        if (ticks > maxTicks())
+            ticks = maxTicks();
+        slots_[(cursor_ + ticks) % slots_.size()].push_back(std::move(item));
+        size_++;
+    }
+
+    // 推进一个刻度，对到期槽中的每个条目调用onExpire(item)，回调中可以再次schedule
+    template <typename F>
+    void tick(F&& onExpire)
+    {
+        cursor_ = (cursor_ + 1) % slots_.size();
+        now_++;
+        // 先把槽换出来，回调里重新schedule的条目不会落回正在处理的槽
+        std::vector<T> expired;
+        expired.swap(slots_[cursor_]);
+        size_ -= expired.size();
+        for (auto& item : expired)
+        {
+            onExpire(item);
+        }
+        // 把处理完的容器还回去，复用它的内存
+        expired.clear();
+        if (slots_[cursor_].empty())
+            slots_[cursor_].swap(expired);
+    }
+
+private:
+    std::vector<std::vector<T>> slots_;
+    size_t                      cursor_; // 当前刻度对应的槽
+    uint64_t                    now_;
+    size_t                      size_;
+};
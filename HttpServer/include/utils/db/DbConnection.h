@@ -1,8 +1,13 @@
 // 负责管理和Mysql的单个连接，执行查询，更新，连接检查和重连等
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <list>
 #include <memory>
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <cppconn/connection.h>
 #include <cppconn/prepared_statement.h>
 #include <cppconn/resultset.h>
@@ -18,6 +23,9 @@ namespace http
         class DbConnection
         {
         public:
+            // 每个连接最多缓存的预处理语句数
+            static const size_t kStmtCacheCapacity = 32;
+
             DbConnection(const std::string &host,
                          const std::string &user,
                          const std::string &password,
@@ -32,18 +40,28 @@ namespace http
             void reconnect();
             void cleanup();
 
+            // 流式查询的语句和结果集，交给ResultCursor持有
+            struct StreamingQuery
+            {
+                std::unique_ptr<sql::PreparedStatement> stmt;
+                std::unique_ptr<sql::ResultSet>         res;
+            };
+
+            // 流式查询：结果集按需逐行从服务器读取，读完或者释放结果集之前，该连接不能执行其他语句
+            // 使用独立的预处理语句而不是缓存，避免缓存淘汰时释放仍在读取的语句
             template <typename... Args>
-            sql::ResultSet *executeQuery(const std::string &sql, Args &&...args)
+            StreamingQuery streamQuery(const std::string &sql, Args &&...args)
             {
                 std::lock_guard<std::mutex> lock(mutex_);
                 try
                 {
-                    // 直接创建新的预处理语句，不使用缓存
-                    std::unique_ptr<sql::PreparedStatement> stmt(conn_->prepareStatement(sql));
-                    bindParams(stmt.get(), 1, std::forward<Args>(args)...);
-                    // std::string sql = "SELECT * FROM users WHERE id = ?"; 绑的是这种
-
-                    return stmt->executeQuery();
+                    StreamingQuery query;
+                    query.stmt.reset(conn_->prepareStatement(sql));
+                    query.stmt->setResultSetType(sql::ResultSet::TYPE_FORWARD_ONLY);
+                    bindParams(query.stmt.get(), 1, std::forward<Args>(args)...);
+                    query.res.reset(query.stmt->executeQuery());
+                    markValidated();
+                    return query;
                 }
                 catch (const sql::SQLException &e)
                 {
@@ -52,28 +70,177 @@ namespace http
                 }
             }
 
+            // 返回的结果集需要调用者delete，且连接此时可能已归还连接池，新代码请使用query()或者MysqlUtil::cursor()
+            // 查询遇到连接断开时会重连并重试一次，借出连接前不再单独ping
             template <typename... Args>
-            int executeUpdate(const std::string &sql, Args &&...args)
+            sql::ResultSet *executeQuery(const std::string &sql, Args &&...args)
             {
                 std::lock_guard<std::mutex> lock(mutex_);
-                try
+                for (int attempt = 0;; attempt++)
                 {
-                    // 直接创建新的预处理语句，不适用缓存
-                    std::unique_ptr<sql::PreparedStatement> stmt(conn_->prepareStatement(sql));
+                    try
+                    {
+                        // 直接创建新的预处理语句，不使用缓存
+                        std::unique_ptr<sql::PreparedStatement> stmt(conn_->prepareStatement(sql));
+                        bindParams(stmt.get(), 1, std::forward<Args>(args)...);
+                        // std::string sql = "SELECT * FROM users WHERE id = ?"; 绑的是这种
 
-                    bindParams(stmt.get(), 1, std::forward<Args>(args)...);
-                    return stmt->executeUpdate();
+                        sql::ResultSet *res = stmt->executeQuery();
+                        markValidated();
+                        return res;
+                    }
+                    catch (const sql::SQLException &e)
+                    {
+                        if (attempt == 0 && !pinned_ && isConnectionLost(e.getErrorCode()))
+                        {
+                            LOG_WARN << "Connection lost during query, reconnecting: " << e.what();
+                            reconnectLocked();
+                            continue;
+                        }
+                        LOG_ERROR << "Query failed: " << e.what() << ",SQL: " << sql;
+                        throw DbException(e.what());
+                    }
                 }
-                catch (const sql::SQLException &e)
+            }
+
+            // 使用缓存的预处理语句执行查询，在持有连接期间用fn处理结果集，返回fn的返回值
+            // 结果集在返回前就已释放，不会被之后复用同一语句的查询覆盖
+            template <typename Fn, typename... Args>
+            auto query(const std::string &sql, Fn &&fn, Args &&...args)
+                -> decltype(fn(std::declval<sql::ResultSet &>()))
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (int attempt = 0;; attempt++)
                 {
-                    LOG_ERROR << "Update failed : " << e.what() << ", SQL: " << sql;
-                    throw DbException(e.what());
+                    try
+                    {
+                        sql::PreparedStatement *stmt = getCachedStatement(sql);
+                        bindParams(stmt, 1, std::forward<Args>(args)...);
+                        std::unique_ptr<sql::ResultSet> res(stmt->executeQuery());
+                        markValidated();
+                        return fn(*res);
+                    }
+                    catch (const sql::SQLException &e)
+                    {
+                        dropCachedStatement(sql);
+                        if (attempt == 0 && !pinned_ && isConnectionLost(e.getErrorCode()))
+                        {
+                            LOG_WARN << "Connection lost during query, reconnecting: " << e.what();
+                            reconnectLocked();
+                            continue;
+                        }
+                        LOG_ERROR << "Query failed: " << e.what() << ",SQL: " << sql;
+                        throw DbException(e.what());
+                    }
+                }
+            }
+
+            template <typename... Args>
+            int executeUpdate(const std::string &sql, Args &&...args)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (int attempt = 0;; attempt++)
+                {
+                    try
+                    {
+                        // 使用缓存的预处理语句，省去每次prepare的一次往返
+                        sql::PreparedStatement *stmt = getCachedStatement(sql);
+
+                        bindParams(stmt, 1, std::forward<Args>(args)...);
+                        int rows = stmt->executeUpdate();
+                        markValidated();
+                        return rows;
+                    }
+                    catch (const sql::SQLException &e)
+                    {
+                        dropCachedStatement(sql);
+                        // 更新语句只在请求确定没有发到服务器时(2006)重试，避免重复执行
+                        if (attempt == 0 && !pinned_ && e.getErrorCode() == kServerGoneError)
+                        {
+                            LOG_WARN << "Connection lost before update, reconnecting: " << e.what();
+                            reconnectLocked();
+                            continue;
+                        }
+                        LOG_ERROR << "Update failed : " << e.what() << ", SQL: " << sql;
+                        throw DbException(e.what());
+                    }
                 }
             }
 
+            // 执行INSERT并在同一会话上取回自增主键，没有插入任何行时返回0
+            // 配合 INSERT ... SELECT ... WHERE NOT EXISTS 可以把“检查是否存在 + 插入”合成一条语句
+            // INSERT之后连接断开时不能重连再查，新会话的LAST_INSERT_ID()是0，只能抛出异常
+            template <typename... Args>
+            uint64_t executeInsert(const std::string &sql, Args &&...args)
+            {
+                if (executeUpdate(sql, std::forward<Args>(args)...) == 0)
+                    return 0;
+                SessionPin pin(*this);
+                return query("SELECT LAST_INSERT_ID()", [](sql::ResultSet &res) -> uint64_t {
+                    return res.next() ? res.getUInt64(1) : 0;
+                });
+            }
+
             bool ping();
 
+            // 距离上次确认连接可用（ping成功或者查询成功）是否不超过seconds秒
+            bool validatedWithin(int seconds) const
+            {
+                return nowMs() - lastValidatedMs_.load(std::memory_order_relaxed) <= seconds * 1000LL;
+            }
+
+            // 预处理语句缓存命中统计（所有连接累计）
+            static uint64_t stmtCacheHits() { return stmtCacheHits_.load(std::memory_order_relaxed); }
+            static uint64_t stmtCacheMisses() { return stmtCacheMisses_.load(std::memory_order_relaxed); }
+            static double stmtCacheHitRate()
+            {
+                uint64_t hits = stmtCacheHits(), total = hits + stmtCacheMisses();
+                return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+            }
+
         private:
+            // MySQL客户端错误码：服务器已断开 / 查询过程中连接丢失 / 连接处于异常状态
+            static const int kServerGoneError = 2006;
+            static const int kServerLostError = 2013;
+            static const int kServerLostExtendedError = 2055;
+
+            static bool isConnectionLost(int code)
+            {
+                return code == kServerGoneError || code == kServerLostError || code == kServerLostExtendedError;
+            }
+
+            static int64_t nowMs()
+            {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            void markValidated() { lastValidatedMs_.store(nowMs(), std::memory_order_relaxed); }
+
+            // 依赖会话状态的操作期间固定在当前会话上，析构时恢复，可以嵌套
+            class SessionPin
+            {
+            public:
+                explicit SessionPin(DbConnection &conn) : conn_(conn), saved_(conn.pinned_) { conn_.pinned_ = true; }
+                ~SessionPin() { conn_.pinned_ = saved_; }
+
+                SessionPin(const SessionPin &) = delete;
+                SessionPin &operator=(const SessionPin &) = delete;
+
+            private:
+                DbConnection &conn_;
+                bool          saved_;
+            };
+
+            // 以下函数需在持有mutex_时调用
+            // 从LRU缓存中取预处理语句，没有则prepare并放入缓存
+            sql::PreparedStatement *getCachedStatement(const std::string &sql);
+            // 语句执行出错时从缓存中移除，下次重新prepare
+            void dropCachedStatement(const std::string &sql);
+            // 连接断开后缓存的语句全部失效
+            void clearStatementCache();
+            void reconnectLocked();
+
             // 下面三个函数构成一个递归模板函数
 
             // 辅助函数，递归终止条件,当没有参数要绑定时，递归结束
@@ -101,12 +268,22 @@ namespace http
             }
 
         private:
+            using StmtEntry = std::pair<std::string, std::unique_ptr<sql::PreparedStatement>>;
+
             std::shared_ptr<sql::Connection>    conn_;
             std::string                         host_;
             std::string                         user_;
             std::string                         password_;
             std::string                         database_;
             std::mutex                          mutex_;
+            std::atomic<int64_t>                lastValidatedMs_{0};
+            bool                                pinned_ = false; // 为true时连接断开不重连重试，只在借出连接的线程中访问
+            // 预处理语句LRU缓存，表头是最近使用的，必须声明在conn_之后，保证先于连接析构
+            std::list<StmtEntry>                                           stmtLru_;
+            std::unordered_map<std::string, std::list<StmtEntry>::iterator> stmtIndex_;
+
+            static std::atomic<uint64_t>        stmtCacheHits_;
+            static std::atomic<uint64_t>        stmtCacheMisses_;
         };
 
     } // namespace db
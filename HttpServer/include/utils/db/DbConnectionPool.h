@@ -1,15 +1,33 @@
 #pragma once
-#include <queue>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <memory>
 #include <thread>
+#include <vector>
 #include "DbConnection.h"
+#include "DbPoolConfig.h"
 
 namespace http
 {
     namespace db
     {
+        // 连接池运行状态快照
+        struct DbPoolStats
+        {
+            // 等待时间直方图各个桶的上界（毫秒），最后一个桶统计超过最大上界的等待
+            static constexpr std::array<int, 6> kWaitBucketsMs = {{1, 5, 20, 100, 500, 2000}};
+
+            size_t   total = 0;          // 当前连接总数（包括借出的）
+            size_t   idle = 0;           // 空闲连接数
+            size_t   waiting = 0;        // 正在等待连接的线程数
+            uint64_t acquired = 0;       // 累计成功借出次数
+            uint64_t timeouts = 0;       // 累计等待超时次数
+            std::array<uint64_t, kWaitBucketsMs.size() + 1> waitHistogram{}; // 获取连接的等待时间分布
+        };
 
         class DbConnectionPool
         {
@@ -26,12 +44,36 @@ namespace http
                       const std::string &user,
                       const std::string &password,
                       const std::string &database,
-                      size_t poolSize = 10);
+                      const DbPoolConfig &config);
+
+            // 固定大小的连接池
+            void init(const std::string &host,
+                      const std::string &user,
+                      const std::string &password,
+                      const std::string &database,
+                      size_t poolSize = 10)
+            {
+                init(host, user, password, database, DbPoolConfig::fixedSize(poolSize));
+            }
             
-            //获取连接
+            //获取连接，没有空闲连接且已达到上限时最多等待acquireTimeoutMs，超时抛出DbException
             std::shared_ptr<DbConnection> getConnection();
 
+            DbPoolStats stats();
+
         private:
+            // 后台线程的检查周期，以及超过多久没有确认可用的空闲连接需要ping一次（秒）
+            static const int kCheckIntervalSeconds = 10;
+            static const int kValidateIntervalSeconds = 30;
+
+            using Clock = std::chrono::steady_clock;
+
+            struct IdleConnection
+            {
+                std::shared_ptr<DbConnection> conn;
+                Clock::time_point             lastUsed;
+            };
+
             // 构造函数
             DbConnectionPool();
             // 析构函数
@@ -42,15 +84,27 @@ namespace http
             DbConnectionPool &operator=(const DbConnectionPool &) = delete;
 
             std::shared_ptr<DbConnection> createConnection();
+            // 包装成借出的连接，引用计数归零时自动归还
+            std::shared_ptr<DbConnection> lend(std::shared_ptr<DbConnection> conn);
+            void release(std::shared_ptr<DbConnection> conn);
+            void recordWait(Clock::duration waited);
 
             void checkConnections(); // 添加连接检查方法
+            void shrinkIdle();       // 回收空闲过久的连接
+            void ensureMinSize();    // 连接创建失败后补足常驻连接
 
         private:
             std::string host_;
             std::string user_;
             std::string password_;
             std::string database_;
-            std::queue<std::shared_ptr<DbConnection>> connections_;
+            DbPoolConfig config_;
+            std::deque<IdleConnection> connections_; // 空闲连接，队尾是最近归还的
+            size_t total_ = 0;                       // 连接总数，包括借出的和正在创建的
+            size_t waiting_ = 0;
+            uint64_t acquired_ = 0;
+            uint64_t timeouts_ = 0;
+            std::array<uint64_t, DbPoolStats::kWaitBucketsMs.size() + 1> waitHistogram_{};
             std::mutex mutex_;
             std::condition_variable cv_;
             bool initialized_ = false;
@@ -58,4 +112,4 @@ namespace http
         };
 
     } // namespace db
-} // namespace http
\ No newline at end of file
+} // namespace http
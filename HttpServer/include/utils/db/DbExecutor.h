@@ -0,0 +1,50 @@
+// 数据库专用线程池：阻塞的MySQL调用放到这里执行，不占用muduo的IO线程
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include <muduo/base/ThreadPool.h>
+
+namespace http
+{
+    namespace db
+    {
+        class DbExecutor
+        {
+        public:
+            using Task = std::function<void()>;
+
+            // 单例模式
+            static DbExecutor &getInstance()
+            {
+                static DbExecutor instance;
+                return instance;
+            }
+
+            // 启动线程池，重复调用无效
+            void start(int numThreads);
+
+            // 结束并等待所有线程，用于服务器退出时在销毁EventLoop之前停止投递异步应答
+            void stop();
+
+            // 提交任务，线程池未启动时在当前线程直接执行
+            void run(Task task);
+
+        private:
+            DbExecutor() : pool_("DbExecutor"), started_(false) {}
+            ~DbExecutor();
+
+            // 禁止拷贝构造
+            DbExecutor(const DbExecutor &) = delete;
+            DbExecutor &operator=(const DbExecutor &) = delete;
+
+        private:
+            muduo::ThreadPool pool_;
+            std::atomic<bool> started_;
+            std::mutex        mutex_;
+        };
+
+    } // namespace db
+} // namespace http
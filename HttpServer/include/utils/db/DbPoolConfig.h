@@ -0,0 +1,33 @@
+// 数据库连接池配置：连接数上下限、获取连接的超时时间、空闲连接回收时间
+#pragma once
+
+#include <cstddef>
+
+namespace http
+{
+    namespace db
+    {
+        struct DbPoolConfig
+        {
+            size_t minSize = 4;              // 常驻连接数，空闲回收不会低于这个值
+            size_t maxSize = 16;             // 连接数上限，负载高时按需扩容到这个值
+            int acquireTimeoutMs = 3000;     // 获取连接最多等待的时间，超时抛出DbException
+            int idleTimeoutSeconds = 300;    // 超出minSize的连接空闲这么久后关闭
+
+            static DbPoolConfig defaultConfig()
+            {
+                return DbPoolConfig();
+            }
+
+            // 固定大小的连接池，与原来init(poolSize)的行为一致
+            static DbPoolConfig fixedSize(size_t poolSize)
+            {
+                DbPoolConfig config;
+                config.minSize = poolSize;
+                config.maxSize = poolSize;
+                return config;
+            }
+        };
+
+    } // namespace db
+} // namespace http
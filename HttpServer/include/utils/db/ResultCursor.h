@@ -0,0 +1,131 @@
+// 查询结果游标：持有借出的连接直到游标析构，逐行从服务器读取结果，不把整个结果集缓存在客户端
+// 通过特化DbColumns<T>提供编译期列映射，可以直接把每一行解码成结构体
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "DbConnection.h"
+
+namespace http
+{
+    namespace db
+    {
+        // 列映射：结果集中名为name的列对应结构体T的成员member
+        template <typename T, typename M>
+        struct DbColumn
+        {
+            const char *name;
+            M T::*member;
+        };
+
+        template <typename T, typename M>
+        constexpr DbColumn<T, M> dbColumn(const char *name, M T::*member)
+        {
+            return {name, member};
+        }
+
+        // 为需要解码的结构体特化，例如：
+        // struct User { int id; std::string username; };
+        // template <> struct DbColumns<User>
+        // {
+        //     static constexpr auto columns = std::make_tuple(dbColumn("id", &User::id),
+        //                                                     dbColumn("username", &User::username));
+        // };
+        template <typename T>
+        struct DbColumns;
+
+        namespace detail
+        {
+            inline void readColumn(const sql::ResultSet &rs, const char *name, int32_t &out) { out = rs.getInt(name); }
+            inline void readColumn(const sql::ResultSet &rs, const char *name, int64_t &out) { out = rs.getInt64(name); }
+            inline void readColumn(const sql::ResultSet &rs, const char *name, uint64_t &out) { out = rs.getUInt64(name); }
+            inline void readColumn(const sql::ResultSet &rs, const char *name, double &out) { out = rs.getDouble(name); }
+            inline void readColumn(const sql::ResultSet &rs, const char *name, bool &out) { out = rs.getBoolean(name); }
+            // getString返回的是SQLString临时对象，直接赋值，不能绑定引用
+            inline void readColumn(const sql::ResultSet &rs, const char *name, std::string &out) { out = rs.getString(name); }
+        } // namespace detail
+
+        class ResultCursor
+        {
+        public:
+            ResultCursor(std::shared_ptr<DbConnection> conn, DbConnection::StreamingQuery query)
+                : conn_(std::move(conn)), stmt_(std::move(query.stmt)), res_(std::move(query.res))
+            {
+            }
+
+            // 只能移动，不能拷贝
+            ResultCursor(ResultCursor &&) = default;
+            ResultCursor &operator=(ResultCursor &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    // 按析构的顺序释放当前持有的资源，连接必须最后归还，否则可能在结果集读完之前被其他线程借走
+                    res_.reset();
+                    stmt_.reset();
+                    conn_.reset();
+                    conn_ = std::move(other.conn_);
+                    stmt_ = std::move(other.stmt_);
+                    res_ = std::move(other.res_);
+                }
+                return *this;
+            }
+            ResultCursor(const ResultCursor &) = delete;
+            ResultCursor &operator=(const ResultCursor &) = delete;
+
+            // 成员按声明的逆序析构：先释放结果集（读完剩余的行），再释放语句，最后把连接归还连接池
+            ~ResultCursor() = default;
+
+            // 移动到下一行，没有更多行返回false
+            bool next()
+            {
+                return res_ && res_->next();
+            }
+
+            // 当前行，用于手动读取列
+            const sql::ResultSet &row() const
+            {
+                return *res_;
+            }
+
+            // 移动到下一行并按DbColumns<T>解码到out
+            template <typename T>
+            bool next(T &out)
+            {
+                if (!next())
+                    return false;
+                decode(out);
+                return true;
+            }
+
+            // 读出剩余的所有行
+            template <typename T>
+            std::vector<T> all()
+            {
+                std::vector<T> rows;
+                T row;
+                while (next(row))
+                    rows.push_back(row);
+                return rows;
+            }
+
+        private:
+            template <typename T>
+            void decode(T &out) const
+            {
+                std::apply([&](const auto &...column) {
+                    (detail::readColumn(*res_, column.name, out.*(column.member)), ...);
+                }, DbColumns<T>::columns);
+            }
+
+        private:
+            std::shared_ptr<DbConnection>           conn_; // 借出的连接，游标析构时归还
+            std::unique_ptr<sql::PreparedStatement> stmt_;
+            std::unique_ptr<sql::ResultSet>         res_;
+        };
+
+    } // namespace db
+} // namespace http
@@ -0,0 +1,114 @@
+#include "../../include/http/ConnectionWheel.h"
+
+#include <algorithm>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+
+    namespace
+    {
+        const uint64_t kNoDeadline = UINT64_MAX;
+
+        size_t slotsFor(const TimeoutConfig &config)
+        {
+            int longest = std::max({config.headerSeconds, config.bodySeconds, config.keepAliveSeconds, 1});
+            // 截止刻度最多比当前刻度晚longest + 1，再多一个槽给当前刻度
+            return static_cast<size_t>(longest) + 2;
+        }
+    } // namespace
+
+    ConnectionWheel::ConnectionWheel(muduo::net::EventLoop *loop, const TimeoutConfig &config)
+        : loop_(loop),
+          config_(config),
+          wheel_(slotsFor(config)),
+          timedOut_(0)
+    {
+    }
+
+    void ConnectionWheel::start()
+    {
+        loop_->runEvery(1.0, std::bind(&ConnectionWheel::onTick, this));
+    }
+
+    void ConnectionWheel::enter(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, HttpContext::TimeoutPhase phase)
+    {
+        uint64_t ticks = ticksFor(phase);
+        uint64_t deadline = ticks == 0 ? kNoDeadline : wheel_.now() + ticks;
+        context->setDeadline(phase, deadline);
+        if (deadline == kNoDeadline)
+        {
+            // 已在时间轮中的条目到期时发现没有截止时间，会自行丢弃
+            return;
+        }
+        // 截止时间推后时保留原来的条目，到期时再顺延；提前时（比如从keep-alive进入读请求头）才加一个新条目
+        if (context->scheduledTick() == 0 || deadline < context->scheduledTick())
+        {
+            schedule(conn, context, deadline);
+        }
+    }
+
+    void ConnectionWheel::onTick()
+    {
+        wheel_.tick([this](Entry &entry) {
+            muduo::net::TcpConnectionPtr conn = entry.first.lock();
+            if (!conn || !conn->connected())
+            {
+                return;
+            }
+            HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+            // 连接已经有更早的条目替代了这一个
+            if (!context || context->scheduledTick() != entry.second)
+            {
+                return;
+            }
+            context->setScheduledTick(0);
+
+            uint64_t deadline = context->deadlineTick();
+            if (deadline == kNoDeadline)
+            {
+                return;
+            }
+            if (deadline <= wheel_.now())
+            {
+                timedOut_.fetch_add(1, std::memory_order_relaxed);
+                LOG_INFO << "Connection " << conn->name() << " timed out in phase " << context->timeoutPhase();
+                conn->forceClose();
+            }
+            else
+            {
+                schedule(entry.first, context, deadline);
+            }
+        });
+    }
+
+    uint64_t ConnectionWheel::ticksFor(HttpContext::TimeoutPhase phase) const
+    {
+        int seconds = 0;
+        switch (phase)
+        {
+        case HttpContext::kReadingHeader:
+            seconds = config_.headerSeconds;
+            break;
+        case HttpContext::kReadingBody:
+            seconds = config_.bodySeconds;
+            break;
+        case HttpContext::kIdle:
+            seconds = config_.keepAliveSeconds;
+            break;
+        }
+        // 当前刻度已经过去了一部分，多加一个刻度保证不会提前超时
+        return seconds <= 0 ? 0 : static_cast<uint64_t>(seconds) + 1;
+    }
+
+    void ConnectionWheel::schedule(const std::weak_ptr<muduo::net::TcpConnection> &conn, HttpContext *context, uint64_t deadline)
+    {
+        // 超出时间轮范围的先放在最远的槽，到期时再顺延
+        uint64_t ticks = std::min<uint64_t>(deadline - wheel_.now(), wheel_.maxTicks());
+        uint64_t fireTick = wheel_.now() + ticks;
+        wheel_.schedule(Entry(conn, fireTick), static_cast<size_t>(ticks));
+        context->setScheduledTick(fireTick);
+    }
+
+} // namespace http
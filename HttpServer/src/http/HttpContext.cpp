@@ -51,7 +51,7 @@ namespace http
                         // GET/HEAD/DELETE等是没有请求体的，POST/PUT有
                         if (request_.method() == HttpRequest::kPost || request_.method() == HttpRequest::kPut)
                         {
-                            std::string contentLength = request_.getHeader("Content-Length");
+                            const std::string &contentLength = request_.getHeader(HttpHeaders::kContentLength);
                             if (!contentLength.empty())
                             {
                                 request_.setContentLength(std::stoi(contentLength));
@@ -100,8 +100,7 @@ namespace http
                     return true;
                 }
                 // 只读取Content-Length长度的数据
-                std::string body(buf->peek(), buf->peek() + request_.contentLength());
-                request_.setBody(body);
+                request_.setBody(buf->peek(), buf->peek() + request_.contentLength());
 
                 buf->retrieve(request_.contentLength());
 
@@ -0,0 +1,152 @@
+#include "../../include/http/HttpHeaders.h"
+
+#include <cassert>
+#include <cstring>
+#include <strings.h>
+
+namespace http
+{
+
+    const char *const HttpHeaders::kKnownNames[kKnownCount] = {
+        "Host",
+        "Cookie",
+        "Content-Type",
+        "Content-Length",
+        "Connection",
+        "Accept",
+        "Origin",
+        "Set-Cookie",
+    };
+
+    namespace
+    {
+        const int kSlotBits = 4;
+        const int kSlotCount = 1 << kSlotBits;
+
+        // 长度、首字符、尾字符（都转小写）组合成的哈希，对kKnownNames没有冲突
+        inline unsigned slotOf(const char *name, size_t len)
+        {
+            unsigned first = static_cast<unsigned char>(name[0]) | 0x20;
+            unsigned last = static_cast<unsigned char>(name[len - 1]) | 0x20;
+            return (static_cast<unsigned>(len) * 6 + first + (last << 1)) & (kSlotCount - 1);
+        }
+
+        // 槽位 -> 常用头部编号，空槽为-1
+        const int8_t *slotTable()
+        {
+            static int8_t table[kSlotCount];
+            static bool inited = [] {
+                std::memset(table, -1, sizeof(table));
+                for (int i = 0; i < HttpHeaders::kKnownCount; i++)
+                {
+                    const char *name = HttpHeaders::kKnownNames[i];
+                    unsigned slot = slotOf(name, std::strlen(name));
+                    assert(table[slot] == -1 && "known header hash collision");
+                    table[slot] = static_cast<int8_t>(i);
+                }
+                return true;
+            }();
+            (void)inited;
+            return table;
+        }
+    } // namespace
+
+    int HttpHeaders::knownIndex(const char *name, size_t len)
+    {
+        if (len == 0)
+            return -1;
+        int index = slotTable()[slotOf(name, len)];
+        if (index < 0)
+            return -1;
+        const char *known = kKnownNames[index];
+        if (std::strlen(known) != len || ::strncasecmp(known, name, len) != 0)
+            return -1;
+        return index;
+    }
+
+    const std::string &HttpHeaders::empty()
+    {
+        static const std::string kEmpty;
+        return kEmpty;
+    }
+
+    void HttpHeaders::set(const char *name, size_t nameLen, const char *value, size_t valueLen)
+    {
+        int index = knownIndex(name, nameLen);
+        if (index >= 0)
+        {
+            known_[index].assign(value, valueLen);
+            present_ |= 1u << index;
+            return;
+        }
+
+        // 同名头部覆盖旧值，与原来std::map的行为一致
+        Entry *entry = const_cast<Entry *>(findExtra(name, nameLen));
+        if (!entry)
+        {
+            if (extraSize_ == extra_.size())
+                extra_.emplace_back();
+            entry = &extra_[extraSize_++];
+            entry->name.assign(name, nameLen);
+        }
+        entry->value.assign(value, valueLen);
+    }
+
+    const std::string &HttpHeaders::get(const std::string &name) const
+    {
+        int index = knownIndex(name.data(), name.size());
+        if (index >= 0)
+            return get(static_cast<Known>(index));
+        const Entry *entry = findExtra(name.data(), name.size());
+        return entry ? entry->value : empty();
+    }
+
+    bool HttpHeaders::has(const std::string &name) const
+    {
+        int index = knownIndex(name.data(), name.size());
+        if (index >= 0)
+            return has(static_cast<Known>(index));
+        return findExtra(name.data(), name.size()) != nullptr;
+    }
+
+    size_t HttpHeaders::size() const
+    {
+        return static_cast<size_t>(__builtin_popcount(present_)) + extraSize_;
+    }
+
+    void HttpHeaders::clear()
+    {
+        for (int i = 0; i < kKnownCount; i++)
+        {
+            if ((present_ >> i) & 1u)
+                known_[i].clear();
+        }
+        present_ = 0;
+        for (size_t i = 0; i < extraSize_; i++)
+        {
+            extra_[i].name.clear();
+            extra_[i].value.clear();
+        }
+        extraSize_ = 0;
+    }
+
+    void HttpHeaders::swap(HttpHeaders &that)
+    {
+        known_.swap(that.known_);
+        std::swap(present_, that.present_);
+        extra_.swap(that.extra_);
+        std::swap(extraSize_, that.extraSize_);
+    }
+
+    const HttpHeaders::Entry *HttpHeaders::findExtra(const char *name, size_t len) const
+    {
+        for (size_t i = 0; i < extraSize_; i++)
+        {
+            const Entry &entry = extra_[i];
+            if (entry.name.size() == len && ::strncasecmp(entry.name.data(), name, len) == 0)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+} // namespace http
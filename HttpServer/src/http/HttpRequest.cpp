@@ -3,6 +3,11 @@
 namespace http
 {
 
+    namespace
+    {
+        const std::string kEmpty;
+    } // namespace
+
     void HttpRequest::setReceiveTime(muduo::Timestamp t)
     {
         receiveTime_ = t;
@@ -51,24 +56,24 @@ namespace http
         pathParameters_[key] = value;
     }
 
-    std::string HttpRequest::getPathParameters(const std::string &key) const
+    const std::string &HttpRequest::getPathParameters(const std::string &key) const
     {
         auto it = pathParameters_.find(key);
         if (it != pathParameters_.end())
         {
             return it->second;
         }
-        return "";
+        return kEmpty;
     }
 
-    std::string HttpRequest::getQueryParameters(const std::string &key) const
+    const std::string &HttpRequest::getQueryParameters(const std::string &key) const
     {
         auto it = queryParameters_.find(key);
         if (it != queryParameters_.end())
         {
             return it->second;
         }
-        return "";
+        return kEmpty;
     }
 
     // 从问号后面分割参数，得到url中的？部分后，用这个函数分割
@@ -107,27 +112,16 @@ namespace http
     // 解析Http请求头，从:分割，并去除冒号
     void HttpRequest::addHeader(const char *start, const char *colon, const char *end)
     {
-        std::string key(start, colon);
-        ++colon;
-        while (colon < end && isspace(*colon))
+        const char *value = colon + 1;
+        while (value < end && isspace(*value))
         {
-            ++colon;
+            ++value;
         }
-        std::string value(colon, end);
-        while (!value.empty() && isspace(value[value.size() - 1]))
+        while (end > value && isspace(*(end - 1)))
         {
-            value.resize(value.size() - 1);
-        }
-        headers_[key] = value;
-    }
-
-    std::string HttpRequest::getHeader(const std::string &field) const{
-        std::string result;
-        auto it = headers_.find(field);
-        if(it != headers_.end()){
-            result = it->second;
+            --end;
         }
-        return result;
+        headers_.set(start, colon - start, value, end - value);
     }
 
     //方便拷贝刷新HttpRequest对象的内容
@@ -138,8 +132,24 @@ namespace http
         std::swap(pathParameters_, that.pathParameters_);
         std::swap(queryParameters_, that.queryParameters_);
         std::swap(version_, that.version_);
-        std::swap(headers_, that.headers_);
+        headers_.swap(that.headers_);
         std::swap(receiveTime_, that.receiveTime_);
+        std::swap(content_, that.content_);
+        std::swap(contentLength_, that.contentLength_);
+        std::swap(peerIp_, that.peerIp_);
+    }
+
+    void HttpRequest::reset()
+    {
+        method_ = kInvalid;
+        version_ = "Unknown";
+        path_.clear();
+        pathParameters_.clear();
+        queryParameters_.clear();
+        receiveTime_ = muduo::Timestamp();
+        headers_.clear();
+        content_.clear();
+        contentLength_ = 0;
     }
 
 } // namespace http
\ No newline at end of file
@@ -23,13 +23,13 @@ namespace http
             outputBuf->append("Connection: Keep-Alive\r\n");
         }
 
-        for (const auto &header : headers_)
+        headers_.forEach([outputBuf](const std::string &name, const std::string &value)
         {
-            outputBuf->append(header.first);
+            outputBuf->append(name);
             outputBuf->append(": ");
-            outputBuf->append(header.second);
+            outputBuf->append(value);
             outputBuf->append("\r\n");
-        }
+        });
         outputBuf->append("\r\n");
 
         outputBuf->append(body_);
@@ -1,12 +1,50 @@
 #include "../../include/http/HttpServer.h"
 
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/socket.h>
+
 #include <any>
 #include <functional>
+#include <future>
 #include <memory>
+#include <thread>
 
 namespace http
 {
 
+    namespace
+    {
+        // 过载时的应答是固定的，不经过HttpResponse组装
+        const char kServiceUnavailable[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                                           "Retry-After: 1\r\n"
+                                           "Content-Length: 0\r\n"
+                                           "Connection: close\r\n\r\n";
+
+        // 由信号处理函数设置，主循环定期检查
+        std::atomic<bool> g_stopRequested(false);
+
+        // 把当前线程绑定到指定的CPU核上，失败只记录日志
+        void bindCurrentThreadToCpu(int index)
+        {
+            unsigned cpus = std::thread::hardware_concurrency();
+            if (cpus == 0)
+            {
+                return;
+            }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(index % cpus, &set);
+            int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (err != 0)
+            {
+                LOG_WARN << "Failed to bind thread to cpu " << index % cpus << ", error " << err;
+            }
+        }
+    } // namespace
+
     // 默认http回应函数
     void defaultHttpCallback(const HttpRequest &request, HttpResponse *resp)
     {
@@ -16,26 +54,289 @@ namespace http
     }
 
     HttpServer::HttpServer(int port, const std::string &name, bool useSSL, muduo::net::TcpServer::Option option)
-        : listenAddr_(port), server_(&mainLoop_, listenAddr_, name, option), useSSL_(useSSL),
+        : name_(name), listenAddr_(port),
+          threadPool_(std::make_unique<muduo::net::EventLoopThreadPool>(&mainLoop_, name)), option_(option),
+          numThreads_(0), reusePortListeners_(false), cpuAffinity_(false), dispatch_(false),
+          drainSeconds_(30.0), forcedClose_(false), loopsStopped_(false), useSSL_(useSSL),
           httpCallback_(std::bind(&HttpServer::handleRequest, this, std::placeholders::_1, std::placeholders::_2))
     {
-        initialize();
     }
 
     // 服务器运行函数
     void HttpServer::start()
     {
-        LOG_WARN << "HttpServer[" << server_.name() << "] starts listening on " << server_.ipPort();
-        server_.start();
+        // 先从旧进程接管监听套接字，接管成功的话旧进程随即停止accept，排队中的连接由本进程继续处理
+        std::vector<int> inherited;
+        if (!handoffPath_.empty())
+        {
+            inherited = ListenerHandoff::fetch(handoffPath_);
+        }
+
+        // 线程初始化回调在每个IO线程中、进入循环前执行；没有IO线程时在当前线程中为主循环执行
+        threadPool_->setThreadNum(numThreads_);
+        threadPool_->start(std::bind(&HttpServer::onThreadInit, this, std::placeholders::_1));
+        startListeners(std::move(inherited));
+
+        if (!handoffPath_.empty())
+        {
+            handoff_ = std::make_unique<ListenerHandoff>(&mainLoop_, handoffPath_);
+            handoff_->listen(std::bind(&HttpServer::listenerFds, this), std::bind(&HttpServer::stopInLoop, this));
+        }
+        mainLoop_.runEvery(0.2, std::bind(&HttpServer::onHousekeeping, this));
+
+        LOG_WARN << "HttpServer[" << name_ << "] starts listening on " << listenAddr_.toIpPort();
         mainLoop_.loop();
+
+        shutdownLoops();
+        LOG_WARN << "HttpServer[" << name_ << "] stopped";
+    }
+
+    void HttpServer::startListeners(std::vector<int> inherited)
+    {
+        bool reusePort = option_ == muduo::net::TcpServer::kReusePort;
+        std::vector<muduo::net::EventLoop *> loops{&mainLoop_};
+        if (reusePortListeners_ && !reusePort)
+        {
+            LOG_ERROR << "Reuse-port listeners need TcpServer::kReusePort, fall back to a single acceptor";
+        }
+        else if (reusePortListeners_ && numThreads_ > 0)
+        {
+            // 每个IO线程各自监听，主循环也监听并处理自己accept的连接，需要自己的状态
+            onThreadInit(&mainLoop_);
+            std::vector<muduo::net::EventLoop *> ioLoops = threadPool_->getAllLoops();
+            loops.insert(loops.end(), ioLoops.begin(), ioLoops.end());
+            LOG_WARN << "HttpServer[" << name_ << "] uses " << loops.size() << " reuse-port listeners";
+        }
+        dispatch_ = loops.size() == 1;
+
+        for (size_t i = 0; i < loops.size(); i++)
+        {
+            // 多余的新套接字与接管来的套接字绑定同一个地址，SO_REUSEPORT让内核按连接的四元组哈希分配连接
+            int fd = i < inherited.size() ? inherited[i] : Listener::createSocket(listenAddr_, reusePort);
+            if (fd < 0)
+            {
+                LOG_FATAL << "HttpServer[" << name_ << "] failed to listen on " << listenAddr_.toIpPort();
+            }
+            auto listener = std::make_unique<Listener>(loops[i], fd);
+            Listener *raw = listener.get();
+            listener->setNewConnectionCallback([this, raw](int sockfd, const muduo::net::InetAddress &peerAddr) {
+                newConnection(raw, sockfd, peerAddr);
+            });
+            listeners_.push_back(std::move(listener));
+            loops[i]->runInLoop([raw]() { raw->listen(); });
+        }
+        // 旧进程的监听套接字比本进程多时，多出来的关掉，其中排队的连接会被内核重置
+        for (size_t i = loops.size(); i < inherited.size(); i++)
+        {
+            ::close(inherited[i]);
+        }
+    }
+
+    void HttpServer::newConnection(Listener *listener, int sockfd, const muduo::net::InetAddress &peerAddr)
+    {
+        // 单个监听套接字时把连接轮流分给IO线程，多监听模式下连接留在accept它的EventLoop
+        muduo::net::EventLoop *ioLoop = dispatch_ ? threadPool_->getNextLoop() : listener->loop();
+
+        struct sockaddr_in6 local;
+        memset(&local, 0, sizeof(local));
+        socklen_t len = sizeof(local);
+        ::getsockname(sockfd, reinterpret_cast<struct sockaddr *>(&local), &len);
+        muduo::net::InetAddress localAddr = local.sin6_family == AF_INET
+                                                ? muduo::net::InetAddress(*reinterpret_cast<struct sockaddr_in *>(&local))
+                                                : muduo::net::InetAddress(local);
+
+        std::string connName = name_ + "-" + listenAddr_.toIpPort() + "#" +
+                               std::to_string(nextConnId_.fetch_add(1, std::memory_order_relaxed));
+        auto conn = std::make_shared<muduo::net::TcpConnection>(ioLoop, connName, sockfd, localAddr, peerAddr);
+        conn->setConnectionCallback(std::bind(&HttpServer::onConnection, this, std::placeholders::_1));
+        conn->setMessageCallback(std::bind(&HttpServer::onMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        conn->setCloseCallback(std::bind(&HttpServer::removeConnection, this, std::placeholders::_1));
+        ioLoop->runInLoop([conn, ioLoop]() {
+            if (LoopState *state = loopStateOf(ioLoop))
+            {
+                state->connections.insert(conn);
+            }
+            conn->connectEstablished();
+        });
+    }
+
+    void HttpServer::removeConnection(const muduo::net::TcpConnectionPtr &conn)
+    {
+        // 关闭回调在连接所在的EventLoop中执行
+        muduo::net::EventLoop *ioLoop = conn->getLoop();
+        if (LoopState *state = loopStateOf(ioLoop))
+        {
+            state->connections.erase(conn);
+        }
+        ioLoop->queueInLoop(std::bind(&muduo::net::TcpConnection::connectDestroyed, conn));
+    }
+
+    std::vector<int> HttpServer::listenerFds() const
+    {
+        std::vector<int> fds;
+        for (const auto &listener : listeners_)
+        {
+            if (listener->fd() >= 0)
+            {
+                fds.push_back(listener->fd());
+            }
+        }
+        return fds;
+    }
+
+    void HttpServer::stop()
+    {
+        mainLoop_.runInLoop(std::bind(&HttpServer::stopInLoop, this));
+    }
+
+    void HttpServer::requestStop()
+    {
+        g_stopRequested.store(true, std::memory_order_relaxed);
+    }
+
+    void HttpServer::stopInLoop()
+    {
+        if (draining_.exchange(true))
+        {
+            return;
+        }
+        drainDeadline_ = muduo::addTime(muduo::Timestamp::now(), drainSeconds_);
+        LOG_WARN << "HttpServer[" << name_ << "] stops accepting, draining "
+                 << connections_.load(std::memory_order_relaxed) << " connections";
+
+        for (const auto &listener : listeners_)
+        {
+            Listener *raw = listener.get();
+            raw->loop()->runInLoop([raw]() { raw->stop(); });
+        }
+        std::lock_guard<std::mutex> lock(loopsMutex_);
+        for (const LoopStatePtr &state : loops_)
+        {
+            state->loop->runInLoop([this, state]() {
+                for (const muduo::net::TcpConnectionPtr &conn : state->connections)
+                {
+                    closeIfIdle(conn);
+                }
+            });
+        }
+    }
+
+    void HttpServer::closeIfIdle(const muduo::net::TcpConnectionPtr &conn)
+    {
+        // 正在读请求，或者异步应答的sender还持有响应对象时，等应答发出后再关闭（退出期间的应答都带Connection: close）
+        HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        bool busy = context && (context->inRequest() || context->response().use_count() > 1);
+        if (!busy)
+        {
+            conn->shutdown();
+        }
+    }
+
+    void HttpServer::onHousekeeping()
+    {
+        if (!draining_.load(std::memory_order_relaxed))
+        {
+            if (g_stopRequested.load(std::memory_order_relaxed))
+            {
+                stopInLoop();
+            }
+            return;
+        }
+
+        if (connections_.load(std::memory_order_relaxed) == 0)
+        {
+            mainLoop_.quit();
+            return;
+        }
+        muduo::Timestamp now = muduo::Timestamp::now();
+        if (!forcedClose_ && !(now < drainDeadline_))
+        {
+            forcedClose_ = true;
+            LOG_WARN << "HttpServer[" << name_ << "] drain timed out, force closing "
+                     << connections_.load(std::memory_order_relaxed) << " connections";
+            std::lock_guard<std::mutex> lock(loopsMutex_);
+            for (const LoopStatePtr &state : loops_)
+            {
+                state->loop->runInLoop([state]() {
+                    for (const muduo::net::TcpConnectionPtr &conn : state->connections)
+                    {
+                        conn->forceClose();
+                    }
+                });
+            }
+        }
+        else if (forcedClose_ && !(now < muduo::addTime(drainDeadline_, 1.0)))
+        {
+            // 强制关闭后仍有连接没有回调，不再等待
+            mainLoop_.quit();
+        }
     }
 
-    void HttpServer::initialize()
+    void HttpServer::shutdownLoops()
     {
-        // 设置回调函数
-        server_.setConnectionCallback(std::bind(&HttpServer::onConnection, this, std::placeholders::_1));
+        handoff_.reset();
+        // 监听套接字的Channel只能在所属线程中移除
+        for (auto &listener : listeners_)
+        {
+            muduo::net::EventLoop *loop = listener->loop();
+            if (loop == &mainLoop_)
+            {
+                listener.reset();
+                continue;
+            }
+            std::promise<void> done;
+            loop->runInLoop([&listener, &done]() {
+                listener.reset();
+                done.set_value();
+            });
+            done.get_future().wait();
+        }
+        listeners_.clear();
+
+        // 之后工作线程的异步应答直接丢弃，不再投递到即将销毁的EventLoop
+        {
+            std::lock_guard<std::mutex> lock(sendersMutex_);
+            loopsStopped_ = true;
+        }
+        // 强制关闭后仍未回调的连接在各自的线程中销毁，不能留到EventLoop析构之后
+        std::vector<LoopStatePtr> loops;
+        {
+            std::lock_guard<std::mutex> lock(loopsMutex_);
+            loops = loops_;
+        }
+        for (const LoopStatePtr &state : loops)
+        {
+            if (state->loop == &mainLoop_)
+            {
+                destroyConnections(state.get());
+                continue;
+            }
+            std::promise<void> done;
+            state->loop->runInLoop([this, &state, &done]() {
+                destroyConnections(state.get());
+                done.set_value();
+            });
+            done.get_future().wait();
+        }
+        // EventLoopThread析构时退出循环并等待线程结束
+        threadPool_.reset();
+    }
 
-        server_.setMessageCallback(std::bind(&HttpServer::onMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    void HttpServer::destroyConnections(LoopState *state)
+    {
+        state->loop->assertInLoopThread();
+        if (!state->connections.empty())
+        {
+            LOG_WARN << "HttpServer[" << name_ << "] destroys " << state->connections.size()
+                     << " connections left after drain";
+        }
+        // 与TcpServer析构时相同：还在集合中的连接都没有走过removeConnection，直接销毁
+        std::unordered_set<muduo::net::TcpConnectionPtr> connections;
+        connections.swap(state->connections);
+        for (const muduo::net::TcpConnectionPtr &conn : connections)
+        {
+            conn->connectDestroyed();
+        }
     }
 
     void HttpServer::setSslConfig(const ssl::SslConfig &config)
@@ -51,10 +352,85 @@ namespace http
         }
     }
 
+    ServerStats HttpServer::stats() const
+    {
+        ServerStats stats;
+        stats.connections = connections_.load(std::memory_order_relaxed);
+        stats.rejectedConnections = rejectedConnections_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(loopsMutex_);
+        stats.loops = static_cast<int>(loops_.size());
+        for (const LoopStatePtr &state : loops_)
+        {
+            stats.inFlight += state->inFlight.load(std::memory_order_relaxed);
+            stats.rejectedRequests += state->rejectedRequests.load(std::memory_order_relaxed);
+            stats.timedOut += state->wheel.timedOut();
+        }
+        return stats;
+    }
+
+    void HttpServer::onThreadInit(muduo::net::EventLoop *loop)
+    {
+        if (cpuAffinity_)
+        {
+            bindCurrentThreadToCpu(nextCpu_.fetch_add(1, std::memory_order_relaxed));
+        }
+        // 状态保存在EventLoop的上下文中，同时登记到loops_用于汇总计数；没有IO线程时在主循环中创建
+        auto state = std::make_shared<LoopState>(loop, timeouts_);
+        loop->setContext(state);
+        state->wheel.start();
+        std::lock_guard<std::mutex> lock(loopsMutex_);
+        loops_.push_back(state);
+    }
+
+    HttpServer::LoopState *HttpServer::loopStateOf(muduo::net::EventLoop *loop)
+    {
+        auto *state = boost::any_cast<LoopStatePtr>(loop->getMutableContext());
+        return state ? state->get() : nullptr;
+    }
+
+    void HttpServer::updateTimeout(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, const muduo::net::Buffer *buf)
+    {
+        LoopState *state = loopStateOf(conn->getLoop());
+        if (!state)
+        {
+            return;
+        }
+        HttpContext::TimeoutPhase phase = HttpContext::kIdle;
+        if (context->expectBody())
+        {
+            phase = HttpContext::kReadingBody;
+        }
+        else if (context->inRequest() || buf->readableBytes() > 0)
+        {
+            phase = HttpContext::kReadingHeader;
+        }
+        // 阶段不变时不顺延截止时间，keep-alive的顺延在发送响应时进行
+        if (phase != context->timeoutPhase())
+        {
+            state->wheel.enter(conn, context, phase);
+        }
+    }
+
     void HttpServer::onConnection(const muduo::net::TcpConnectionPtr &conn)
     {
         if (conn->connected())
         {
+            // 超过连接数上限：不创建上下文，明文连接回一个固定的503后关闭，TLS连接握手前无法应答，直接关闭
+            // 先占位再判断，多个IO线程同时建立连接时也不会超出上限
+            int count = connections_.fetch_add(1, std::memory_order_relaxed);
+            if (limits_.maxConnections > 0 && count >= limits_.maxConnections)
+            {
+                connections_.fetch_sub(1, std::memory_order_relaxed);
+                rejectedConnections_.fetch_add(1, std::memory_order_relaxed);
+                LOG_WARN << "Too many connections, reject " << conn->peerAddress().toIpPort();
+                if (!useSSL_)
+                {
+                    conn->send(kServiceUnavailable, sizeof(kServiceUnavailable) - 1);
+                }
+                conn->forceClose();
+                return;
+            }
+
             if (useSSL_)
             {
                 auto sslConn = std::make_unique<ssl::SslConnection>(conn, sslCtx_.get());
@@ -63,9 +439,22 @@ namespace http
                 sslConns_[conn]->startHandshake();
             }
             conn->setContext(HttpContext());
+            // 客户端地址整个连接只取一次，限流等中间件按它区分客户端
+            HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+            context->request().setPeerIp(conn->peerAddress().toIp());
+            // 连接建立后就开始计算读请求头的时间，只连接不发数据的客户端同样会超时
+            if (LoopState *state = loopStateOf(conn->getLoop()))
+            {
+                state->wheel.enter(conn, context, HttpContext::kReadingHeader);
+            }
         }
         else
         {
+            // 被拒绝的连接没有上下文，也没有计入连接数
+            if (!conn->getContext().empty())
+            {
+                connections_.fetch_sub(1, std::memory_order_relaxed);
+            }
             if (useSSL_)
             {
                 sslConns_.erase(conn);
@@ -75,6 +464,12 @@ namespace http
 
     void HttpServer::onMessage(const muduo::net::TcpConnectionPtr &conn, muduo::net::Buffer *buf, muduo::Timestamp receiveTime)
     {
+        // 因连接数上限被拒绝、正在关闭的连接，丢弃收到的数据
+        if (conn->getContext().empty())
+        {
+            buf->retrieveAll();
+            return;
+        }
         try
         {
             // 首先判断是否支持SSL
@@ -117,9 +512,10 @@ namespace http
             // 如果buf缓冲区中解析出一个完整数据包则封装响应报文
             if (context->gotAll())
             {
-                onRequest(conn, context->request());
+                onRequest(conn, context);
                 context->reset();
             }
+            updateTimeout(conn, context, buf);
         }
         catch (const std::exception &e)
         {
@@ -130,40 +526,208 @@ namespace http
         }
     }
 
-    void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, const HttpRequest &req)
+    void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, HttpContext *context)
     {
-        const std::string &connection = req.getHeader("Connection");
-        bool close = ((connection == "close")) || (req.getVersion() == "HTTP/1.0" && connection != "Keep-Alive");
-        HttpResponse response(close); // HTTP/1.0默认短连接
+        HttpRequest &req = context->request();
+        const std::string &connection = req.getHeader(HttpHeaders::kConnection);
+        bool close = ((connection == "close")) || (req.getVersion() == "HTTP/1.0" && connection != "Keep-Alive"); // HTTP/1.0默认短连接
+        // 退出过程中，应答之后就关闭连接
+        close = close || draining_.load(std::memory_order_relaxed);
+
+        // 本EventLoop上处理中的请求（主要是等待数据库、AI等异步应答的）太多时直接拒绝，不再继续堆积
+        LoopState *state = loopStateOf(conn->getLoop());
+        if (state && limits_.maxInFlightPerLoop > 0 &&
+            state->inFlight.load(std::memory_order_relaxed) >= limits_.maxInFlightPerLoop)
+        {
+            state->rejectedRequests.fetch_add(1, std::memory_order_relaxed);
+            conn->send(kServiceUnavailable, sizeof(kServiceUnavailable) - 1);
+            conn->shutdown();
+            return;
+        }
+        if (state)
+        {
+            state->inFlight.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::shared_ptr<HttpResponse> response = acquireResponse(conn, context, close);
 
         // 之后根据请求报文信息来封装响应报文
-        httpCallback_(req, &response); // 执行onHttpCallback函数
+        context->setAwaitingResponse(true);
+        httpCallback_(req, response.get()); // 执行onHttpCallback函数
+
+        // 异步处理的请求由sender稍后发送响应，处理中计数由sender负责减去
+        // 响应发出之前暂停读取，流水线上的后续请求留在缓冲区中，保证按请求顺序应答
+        // sender在处理函数中就被调用时响应已经发出，不需要暂停
+        if (response->isAsync())
+        {
+            if (context->awaitingResponse())
+            {
+                conn->stopRead();
+            }
+            return;
+        }
+        context->setAwaitingResponse(false);
+        sendResponse(conn, *response);
+        if (state)
+        {
+            state->inFlight.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::shared_ptr<HttpResponse> HttpServer::acquireResponse(const muduo::net::TcpConnectionPtr &conn, HttpContext *context, bool close)
+    {
+        // 同一连接上的请求复用同一个响应对象，头部表、响应体和asyncStarter都不用重新分配
+        // 上一个异步响应的sender还持有该对象时不能复用，新建一个替换
+        std::shared_ptr<HttpResponse> &response = context->response();
+        if (response && response.use_count() == 1)
+        {
+            response->reset(close);
+        }
+        else
+        {
+            response = std::make_shared<HttpResponse>(close);
+        }
+
+        // 处理函数调用startAsync()时才创建sender，同步处理的请求没有额外开销
+        if (!response->hasAsyncStarter())
+        {
+            std::weak_ptr<muduo::net::TcpConnection> weakConn(conn);
+            std::weak_ptr<HttpResponse> weakResp(response);
+            response->setAsyncStarter([this, weakConn, weakResp]() {
+                return makeAsyncSender(weakConn, weakResp.lock());
+            });
+        }
+        return response;
+    }
+
+    HttpResponse::AsyncSender HttpServer::makeAsyncSender(const std::weak_ptr<muduo::net::TcpConnection> &weakConn,
+                                                          const std::shared_ptr<HttpResponse> &response)
+    {
+        // sender的所有拷贝都销毁时（应答已发送，或者连接已断开）才减去处理中计数
+        std::shared_ptr<void> inFlight;
+        muduo::net::TcpConnectionPtr owner = weakConn.lock();
+        if (LoopState *state = owner ? loopStateOf(owner->getLoop()) : nullptr)
+        {
+            inFlight.reset(static_cast<void *>(nullptr), [state](void *) {
+                state->inFlight.fetch_sub(1, std::memory_order_relaxed);
+            });
+        }
+
+        return [this, weakConn, response, inFlight](HttpResponse::AsyncFiller fill)
+        {
+            muduo::net::TcpConnectionPtr conn = weakConn.lock();
+            if (!conn)
+            {
+                LOG_INFO << "Connection closed before async response was ready";
+                return;
+            }
+            // 回到连接所在的IO线程，保证对连接和响应的操作都在同一个线程
+            muduo::net::EventLoop *loop = conn->getLoop();
+            auto deliver = [this, conn, response, fill, inFlight]()
+            {
+                try
+                {
+                    fill(response.get());
+                    middlewareChain_.processAfter(*response);
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR << "Exception in async response: " << e.what();
+                    response->setStatusCode(HttpResponse::k500InternalServerError);
+                    response->setStatusMessage("Internal Server Error");
+                    response->setBody(e.what());
+                    response->setContentLength(std::string(e.what()).size());
+                    response->setCloseConnection(true);
+                }
+                sendResponse(conn, *response);
+                resumeRead(conn, *response);
+            };
+            if (loop->isInLoopThread())
+            {
+                deliver();
+                return;
+            }
+            // 其他线程（数据库、口令校验等工作线程）投递时，IO线程可能正在退出，持锁保证投递期间EventLoop不被销毁
+            std::lock_guard<std::mutex> lock(sendersMutex_);
+            if (loopsStopped_)
+            {
+                LOG_INFO << "Server stopped before async response was ready";
+                return;
+            }
+            loop->queueInLoop(std::move(deliver));
+        };
+    }
 
-        muduo::net::Buffer buf;
-        response.appendToBuffer(&buf);
-        // 打印完整响应内容用于调试
-        LOG_INFO << "Sending response:\n"
-                 << buf.toStringPiece().as_string();
+    void HttpServer::sendResponse(const muduo::net::TcpConnectionPtr &conn, HttpResponse &response)
+    {
+        // 退出过程中一律带上Connection: close并在应答后关闭，处理函数可能在onRequest之后又改回了长连接
+        if (draining_.load(std::memory_order_relaxed))
+        {
+            response.setCloseConnection(true);
+        }
+        // 使用连接上复用的输出缓冲区，send之后缓冲区被清空但保留容量
+        HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        muduo::net::Buffer *buf = context->outputBuffer();
+        response.appendToBuffer(buf);
+        // 打印完整响应内容用于调试，只在DEBUG级别下拷贝
+        LOG_DEBUG << "Sending response:\n"
+                  << buf->toStringPiece().as_string();
 
-        conn->send(&buf);
+        conn->send(buf);
         // 如果是短连接的话，返回响应报文后就关闭连接
         if (response.closeConnection())
         {
             conn->shutdown();
         }
+        else if (LoopState *state = loopStateOf(conn->getLoop()))
+        {
+            // 每次应答后重新开始计算keep-alive空闲时间
+            state->wheel.enter(conn, context, HttpContext::kIdle);
+        }
+    }
+
+    void HttpServer::resumeRead(const muduo::net::TcpConnectionPtr &conn, const HttpResponse &response)
+    {
+        HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        if (!context || !context->awaitingResponse())
+        {
+            return;
+        }
+        context->setAwaitingResponse(false);
+        // 处理函数中直接发出的响应还没有暂停读取
+        if (!conn->connected() || conn->isReading())
+        {
+            return;
+        }
+        // 要关闭的连接也恢复读取，才能收到对端的关闭，但不再处理后续请求
+        conn->startRead();
+        if (response.closeConnection())
+        {
+            conn->inputBuffer()->retrieveAll();
+            return;
+        }
+        // 暂停期间已经读入缓冲区的请求不会再触发可读事件，在这里接着处理
+        // SSL连接的数据先经过解密缓冲区，由下一次可读事件处理
+        if (!useSSL_ && conn->inputBuffer()->readableBytes() > 0)
+        {
+            onMessage(conn, conn->inputBuffer(), muduo::Timestamp::now());
+        }
     }
 
     // 执行请求对应的路由处理函数
-    void HttpServer::handleRequest(const HttpRequest &req, HttpResponse *resp)
+    void HttpServer::handleRequest(HttpRequest &req, HttpResponse *resp)
     {
         try
         {
-            // 使用请求前的中间件
-            HttpRequest mutableReq = req;
-            middlewareChain_.processBefore(mutableReq);
+            // 使用请求前的中间件，直接修改连接上下文中的请求，处理完后由HttpContext::reset()清空
+            // 中间件已经直接应答（比如cors预检请求）时不再路由
+            if (!middlewareChain_.processBefore(req, *resp))
+            {
+                return;
+            }
 
             // 路由处理
-            if (!router_.route(mutableReq, resp))
+            if (!router_.route(req, resp))
             {
                 LOG_INFO << "请求的是，url: " << req.method() << " " << req.path();
                 LOG_INFO << "未找到路由，返回404";
@@ -171,13 +735,11 @@ namespace http
                 resp->setStatusMessage("Not Found");
                 resp->setCloseConnection(true);
             }
-            // 处理响应后的中间件
-            middlewareChain_.processAfter(*resp);
-        }
-        catch (const HttpResponse &res)
-        {
-            // 处理中间件抛出的响应（比如cors预检请求）
-            *resp = res;
+            // 处理响应后的中间件，异步响应在发送前再处理
+            if (!resp->isAsync())
+            {
+                middlewareChain_.processAfter(*resp);
+            }
         }
         catch (const std::exception &e)
         {
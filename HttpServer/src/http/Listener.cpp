@@ -0,0 +1,140 @@
+#include "../../include/http/Listener.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+
+    namespace
+    {
+        // 一次可读事件最多accept的连接数，连接洪峰时减少poll次数，又不至于长时间占住循环
+        const int kMaxAcceptsPerRead = 16;
+    } // namespace
+
+    int Listener::createSocket(const muduo::net::InetAddress &addr, bool reusePort)
+    {
+        sa_family_t family = addr.family();
+        int fd = ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+        if (fd < 0)
+        {
+            LOG_SYSERR << "Listener::createSocket socket";
+            return -1;
+        }
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (reusePort && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+        {
+            LOG_SYSERR << "Listener::createSocket SO_REUSEPORT";
+        }
+        socklen_t len = family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+        if (::bind(fd, addr.getSockAddr(), len) < 0)
+        {
+            LOG_SYSERR << "Listener::createSocket bind " << addr.toIpPort();
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    Listener::Listener(muduo::net::EventLoop *loop, int fd)
+        : loop_(loop),
+          fd_(fd),
+          channel_(loop, fd),
+          idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+          listening_(false)
+    {
+        channel_.setReadCallback(std::bind(&Listener::handleRead, this, std::placeholders::_1));
+    }
+
+    Listener::~Listener()
+    {
+        stop();
+        if (idleFd_ >= 0)
+        {
+            ::close(idleFd_);
+        }
+    }
+
+    void Listener::listen()
+    {
+        loop_->assertInLoopThread();
+        // 从旧进程接管的套接字已经在监听，再次listen只会更新backlog
+        if (::listen(fd_, SOMAXCONN) < 0)
+        {
+            LOG_SYSERR << "Listener::listen";
+            return;
+        }
+        listening_ = true;
+        channel_.enableReading();
+    }
+
+    void Listener::stop()
+    {
+        loop_->assertInLoopThread();
+        if (listening_)
+        {
+            channel_.disableAll();
+            channel_.remove();
+            listening_ = false;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void Listener::handleRead(muduo::Timestamp)
+    {
+        for (int i = 0; i < kMaxAcceptsPerRead; i++)
+        {
+            struct sockaddr_in6 addr;
+            memset(&addr, 0, sizeof(addr));
+            socklen_t len = sizeof(addr);
+            int connfd = ::accept4(fd_, reinterpret_cast<struct sockaddr *>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (connfd >= 0)
+            {
+                muduo::net::InetAddress peerAddr = addr.sin6_family == AF_INET
+                                                       ? muduo::net::InetAddress(*reinterpret_cast<struct sockaddr_in *>(&addr))
+                                                       : muduo::net::InetAddress(addr);
+                if (newConnectionCallback_)
+                {
+                    newConnectionCallback_(connfd, peerAddr);
+                }
+                else
+                {
+                    ::close(connfd);
+                }
+                continue;
+            }
+
+            int savedErrno = errno;
+            if (savedErrno == EINTR || savedErrno == ECONNABORTED)
+            {
+                continue;
+            }
+            if (savedErrno == EMFILE || savedErrno == ENFILE)
+            {
+                // 文件描述符耗尽：腾出预留的fd接受连接后立即关闭，否则水平触发下监听套接字会一直可读
+                LOG_WARN << "Listener runs out of file descriptors";
+                ::close(idleFd_);
+                idleFd_ = ::accept(fd_, nullptr, nullptr);
+                ::close(idleFd_);
+                idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+            }
+            else if (savedErrno != EAGAIN && savedErrno != EWOULDBLOCK)
+            {
+                LOG_SYSERR << "Listener::handleRead accept";
+            }
+            break;
+        }
+    }
+
+} // namespace http
@@ -0,0 +1,247 @@
+#include "../../include/http/ListenerHandoff.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+
+    namespace
+    {
+        const size_t kMaxFds = 64;      // 一次最多交接的监听套接字数
+        const int kTimeoutSeconds = 5;  // 交接双方等待对方的最长时间
+        const char kAck = 'k';
+
+        bool fillAddress(const std::string &path, struct sockaddr_un *addr)
+        {
+            memset(addr, 0, sizeof(*addr));
+            addr->sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(addr->sun_path))
+            {
+                LOG_ERROR << "Invalid handoff socket path: " << path;
+                return false;
+            }
+            memcpy(addr->sun_path, path.c_str(), path.size());
+            return true;
+        }
+
+        void setTimeouts(int sock)
+        {
+            struct timeval tv;
+            tv.tv_sec = kTimeoutSeconds;
+            tv.tv_usec = 0;
+            ::setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            ::setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        }
+
+        void closeAll(const std::vector<int> &fds)
+        {
+            for (int fd : fds)
+            {
+                ::close(fd);
+            }
+        }
+    } // namespace
+
+    std::vector<int> ListenerHandoff::fetch(const std::string &path)
+    {
+        struct sockaddr_un addr;
+        if (!fillAddress(path, &addr))
+        {
+            return {};
+        }
+        int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sock < 0)
+        {
+            LOG_SYSERR << "ListenerHandoff::fetch socket";
+            return {};
+        }
+        if (::connect(sock, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            // 没有旧进程在等待交接，正常的首次启动
+            LOG_INFO << "No listener to take over at " << path;
+            ::close(sock);
+            return {};
+        }
+        setTimeouts(sock);
+
+        std::vector<int> fds = recvFds(sock);
+        // 确认收到后旧进程才会停止accept，确认发不出去时不使用收到的套接字，避免两边都以为对方在服务
+        if (!fds.empty() && ::send(sock, &kAck, 1, MSG_NOSIGNAL) != 1)
+        {
+            LOG_SYSERR << "ListenerHandoff::fetch ack";
+            closeAll(fds);
+            fds.clear();
+        }
+        ::close(sock);
+        LOG_WARN << "Took over " << fds.size() << " listening sockets from " << path;
+        return fds;
+    }
+
+    ListenerHandoff::ListenerHandoff(muduo::net::EventLoop *loop, const std::string &path)
+        : loop_(loop),
+          path_(path),
+          fd_(-1),
+          handedOff_(false)
+    {
+    }
+
+    ListenerHandoff::~ListenerHandoff()
+    {
+        if (channel_)
+        {
+            channel_->disableAll();
+            channel_->remove();
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            // 交接之后路径已经属于新进程，不能删除
+            if (!handedOff_)
+            {
+                ::unlink(path_.c_str());
+            }
+        }
+    }
+
+    bool ListenerHandoff::listen(const FdsProvider &provider, const HandedOffCallback &onHandedOff)
+    {
+        loop_->assertInLoopThread();
+        struct sockaddr_un addr;
+        if (!fillAddress(path_, &addr))
+        {
+            return false;
+        }
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+        {
+            LOG_SYSERR << "ListenerHandoff::listen socket";
+            return false;
+        }
+        // 路径可能是上一个进程留下的（已经交接给本进程，或者上一个进程异常退出）
+        ::unlink(path_.c_str());
+        if (::bind(fd_, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(fd_, 4) < 0)
+        {
+            LOG_SYSERR << "ListenerHandoff::listen " << path_;
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        // 拿到监听套接字就能冒充本服务，只允许同一用户连接
+        ::chmod(path_.c_str(), S_IRUSR | S_IWUSR);
+
+        provider_ = provider;
+        onHandedOff_ = onHandedOff;
+        channel_ = std::make_unique<muduo::net::Channel>(loop_, fd_);
+        channel_->setReadCallback(std::bind(&ListenerHandoff::handleRead, this, std::placeholders::_1));
+        channel_->enableReading();
+        return true;
+    }
+
+    void ListenerHandoff::handleRead(muduo::Timestamp)
+    {
+        int client = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+        {
+            LOG_SYSERR << "ListenerHandoff::handleRead accept";
+            return;
+        }
+        if (handedOff_)
+        {
+            ::close(client);
+            return;
+        }
+        // 交接只在重启时发生一次，这里阻塞等待对方确认，最多kTimeoutSeconds秒
+        setTimeouts(client);
+        std::vector<int> fds = provider_ ? provider_() : std::vector<int>();
+        char ack = 0;
+        if (fds.empty() || fds.size() > kMaxFds || !sendFds(client, fds) ||
+            ::recv(client, &ack, 1, 0) != 1 || ack != kAck)
+        {
+            LOG_ERROR << "Listener handoff failed, keep serving";
+            ::close(client);
+            return;
+        }
+        ::close(client);
+
+        handedOff_ = true;
+        LOG_WARN << "Handed off " << fds.size() << " listening sockets over " << path_;
+        if (onHandedOff_)
+        {
+            onHandedOff_();
+        }
+    }
+
+    bool ListenerHandoff::sendFds(int sock, const std::vector<int> &fds)
+    {
+        // 正文是套接字个数，套接字本身放在SCM_RIGHTS控制消息里
+        uint32_t count = static_cast<uint32_t>(fds.size());
+        struct iovec iov;
+        iov.iov_base = &count;
+        iov.iov_len = sizeof(count);
+
+        std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+        if (::sendmsg(sock, &msg, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(count)))
+        {
+            LOG_SYSERR << "ListenerHandoff::sendFds";
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<int> ListenerHandoff::recvFds(int sock)
+    {
+        uint32_t count = 0;
+        struct iovec iov;
+        iov.iov_base = &count;
+        iov.iov_len = sizeof(count);
+
+        std::vector<char> control(CMSG_SPACE(sizeof(int) * kMaxFds));
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        ssize_t n = ::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        std::vector<int> fds;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); n > 0 && cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+            {
+                size_t num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                const int *data = reinterpret_cast<const int *>(CMSG_DATA(cmsg));
+                fds.insert(fds.end(), data, data + num);
+            }
+        }
+        if (n != static_cast<ssize_t>(sizeof(count)) || (msg.msg_flags & MSG_CTRUNC) || fds.size() != count)
+        {
+            LOG_ERROR << "Malformed listener handoff message";
+            closeAll(fds);
+            return {};
+        }
+        return fds;
+    }
+
+} // namespace http
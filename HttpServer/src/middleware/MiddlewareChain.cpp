@@ -5,31 +5,41 @@ namespace http{
     namespace middleware{
 
         void MiddlewareChain::addMiddleware(std::shared_ptr<Middleware> middleware){
-            middlewares_.push_back(middleware);
+            if(middleware){
+                middlewares_.push_back(middleware);
+            }
         }
 
-        void MiddlewareChain::processBefore(HttpRequest &request){
-            for(auto &middleware:middlewares_){
-                middleware->before(request);
+        bool MiddlewareChain::processBefore(HttpRequest &request, HttpResponse &response){
+            for(size_t i = 0; i < middlewares_.size(); i++){
+                if(middlewares_[i]->before(request, response) == Middleware::kRespond){
+                    //短路：只有已经执行过before的外层中间件需要执行after，顺序同样先进后出
+                    while(i-- > 0){
+                        afterOne(*middlewares_[i], response);
+                    }
+                    return false;
+                }
             }
+            return true;
         }
 
         void MiddlewareChain::processAfter(HttpResponse &response){
+            //栈式执行模式（洋葱模型），在执行after时，对应before的顺序先进后出，所以反着找
+            for(auto it = middlewares_.rbegin();it != middlewares_.rend();it++){
+                afterOne(**it, response);
+            }
+        }
+
+        void MiddlewareChain::afterOne(Middleware &middleware, HttpResponse &response){
+            //每个中间件单独捕获异常，一个中间件出错不影响后面的中间件
             try
             {
-                //栈式执行模式（洋葱模型），在执行after时，对应before的顺序先进后出，所以反着找
-                for(auto it = middlewares_.rbegin();it != middlewares_.rend();it++){
-                    //解引用迭代器，直接取出迭代器指向元素
-                    if(*it){
-                        (*it)->after(response);
-                    }
-                }
+                middleware.after(response);
             }
             catch(const std::exception& e)
             {
                 LOG_ERROR << "Error in middleware after processing: " << e.what();
             }
-            
         }
 
     }//namespace middleware
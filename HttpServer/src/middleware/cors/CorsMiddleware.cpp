@@ -9,19 +9,34 @@ namespace http
     namespace middleware
     {
 
-        CorsMiddleware::CorsMiddleware(const CorsConfig &config) : config_(config) {}
+        CorsMiddleware::CorsMiddleware(const CorsConfig &config)
+            : config_(config),
+              allowAllOrigins_(config.allowedOrigins.empty() || // 这是个默认放行全部的逻辑，空时允许所有
+                               std::find(config.allowedOrigins.begin(), config.allowedOrigins.end(), "*") != config.allowedOrigins.end()),
+              allowMethods_(join(config.allowedMethods, ", ")),
+              allowHeaders_(join(config.allowedHeaders, ", ")),
+              maxAge_(std::to_string(config.maxAge))
+        {
+            if (!config_.allowedOrigins.empty())
+            {
+                // HTTP 规范规定：Access-Control-Allow-Origin 响应头最多只能设置一个具体源 或者 所有源
+                // 允许所有源时用"*"，否则用第一个允许的源
+                defaultOrigin_ = allowAllOrigins_ ? "*" : config_.allowedOrigins[0];
+            }
+        }
 
-        void CorsMiddleware::before(HttpRequest &request)
+        CorsMiddleware::Action CorsMiddleware::before(HttpRequest &request, HttpResponse &response)
         {
             LOG_DEBUG << "CorsMiddleware::before - Processing request";
 
             if (request.method() == HttpRequest::Method::kOptions)
             {
-                LOG_INFO << "Processing CORS preflight request";
-                HttpResponse response;
+                // 预检请求直接在response上应答，不再抛出异常
+                LOG_DEBUG << "Processing CORS preflight request";
                 handlePreflightRequest(request, response);
-                throw response;
+                return kRespond;
             }
+            return kContinue;
         }
 
         void CorsMiddleware::after(HttpResponse &response)
@@ -29,43 +44,33 @@ namespace http
             LOG_DEBUG << "CorsMiddleware::after - Processing response";
 
             // 直接添加CORS头，简化处理逻辑
-            if (!config_.allowedOrigins.empty())
+            if (!defaultOrigin_.empty())
             {
-                // 如果允许所有源
-                if (std::find(config_.allowedOrigins.begin(), config_.allowedOrigins.end(), "*") != config_.allowedOrigins.end())
-                {
-                    addCorsHeader(response, "*");
-                }
-                else
-                {
-                    // 添加第一个允许的源
-                    // HTTP 规范规定：Access-Control-Allow-Origin 响应头最多只能设置一个具体源 或者 所有源
-                    addCorsHeader(response, config_.allowedOrigins[0]);
-                }
+                addCorsHeader(response, defaultOrigin_);
             }
         }
 
         bool CorsMiddleware::isOriginAllowed(const std::string &origin) const
         {
-            return config_.allowedOrigins.empty() || // 这是个默认放行全部的逻辑，空时允许所有
-                   std::find(config_.allowedOrigins.begin(), config_.allowedOrigins.end(), "*") != config_.allowedOrigins.end() ||
+            return allowAllOrigins_ ||
                    std::find(config_.allowedOrigins.begin(), config_.allowedOrigins.end(), origin) != config_.allowedOrigins.end();
         }
 
         void CorsMiddleware::handlePreflightRequest(const HttpRequest &request, HttpResponse &response)
         {
-            const std::string &origin = request.getHeader("Origin");
+            const std::string &origin = request.getHeader(HttpHeaders::kOrigin);
 
             if (!isOriginAllowed(origin))
             {
                 LOG_WARN << "Origin not allowed: " << origin;
-                response.setStatusCode(HttpResponse::k403Forbidden);
+                response.setStatusLine(request.getVersion(), HttpResponse::k403Forbidden, "Forbidden");
+                response.setContentLength(0);
                 return;
             }
 
             addCorsHeader(response, origin);
-            response.setStatusCode(HttpResponse::k204NoContent);
-            LOG_INFO << "Preflight request processed successfully";
+            response.setStatusLine(request.getVersion(), HttpResponse::k204NoContent, "No Content");
+            LOG_DEBUG << "Preflight request processed successfully";
         }
 
         void CorsMiddleware::addCorsHeader(HttpResponse &response, const std::string &origin)
@@ -78,17 +83,17 @@ namespace http
                 {
                     response.addHeader("Access-Control-Allow-Credentials", "true");
                 }
-                if (!config_.allowedMethods.empty())
+                if (!allowMethods_.empty())
                 {
-                    response.addHeader("Access-Control-Allow-Methods", join(config_.allowedMethods, ", "));
+                    response.addHeader("Access-Control-Allow-Methods", allowMethods_);
                 }
 
-                if (!config_.allowedHeaders.empty())
+                if (!allowHeaders_.empty())
                 {
-                    response.addHeader("Access-Control-Allow-Headers", join(config_.allowedMethods, ", "));
+                    response.addHeader("Access-Control-Allow-Headers", allowHeaders_);
                 }
 
-                response.addHeader("Access-Control-Allow-Max-Age", std::to_string(config_.maxAge));
+                response.addHeader("Access-Control-Max-Age", maxAge_);
 
                 LOG_DEBUG << "CORS headers added sucessfully";
             }
@@ -0,0 +1,232 @@
+#include "../../../include/middleware/ratelimit/RateLimitMiddleware.h"
+#include "../../../include/utils/JsonWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string_view>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+    namespace middleware
+    {
+
+        namespace
+        {
+            int64_t steadyNowMs()
+            {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            uint64_t capacityOf(const RateLimitRule &rule)
+            {
+                // 容量至少一个令牌，且不超过32位能表示的范围
+                double burst = std::max(rule.burst, 1.0);
+                return static_cast<uint64_t>(std::min(burst * 1000, 4.0e9));
+            }
+
+            // 从Cookie头中取出sessionId，不存在返回空
+            std::string_view sessionIdOf(const std::string &cookie)
+            {
+                size_t pos = cookie.find("sessionId=");
+                if (pos == std::string::npos)
+                    return std::string_view();
+                pos += 10; // 跳过"sessionId="
+                size_t end = cookie.find(';', pos);
+                return std::string_view(cookie).substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+            }
+        } // namespace
+
+        RateLimitMiddleware::RateLimitMiddleware(const RateLimitConfig &config)
+            : config_(config),
+              tooManyBody_(JsonWriter::errorBody("Too Many Requests")),
+              startMs_(steadyNowMs()),
+              wheel_(static_cast<size_t>(std::max(config.idleSeconds, 1)) + 1),
+              nextTickMs_(kTickMs),
+              currentTick_(0),
+              rejected_(0),
+              maxBucketsPerShard_(std::max<size_t>(config.maxBuckets / kShardCount, 1))
+        {
+            for (size_t i = 0; i < config_.rules.size(); i++)
+            {
+                ruleIndex_.emplace(config_.rules[i].path, i);
+            }
+        }
+
+        RateLimitMiddleware::Action RateLimitMiddleware::before(HttpRequest &request, HttpResponse &response)
+        {
+            const RateLimitRule *rule = matchRule(request.path());
+            if (!rule || rule->ratePerSecond <= 0)
+            {
+                return kContinue;
+            }
+
+            int64_t nowMs = elapsedMs();
+            advanceWheel(nowMs);
+
+            size_t ruleIndex = rule == &config_.defaultRule ? config_.rules.size() : rule - config_.rules.data();
+            uint64_t key = bucketKey(ruleIndex, *rule, request);
+            // 溢出桶的key只由规则编号决定，类型位与IP、会话的都不同
+            uint64_t overflowKey = (static_cast<uint64_t>(ruleIndex) << 2 | 3) * 0x9E3779B97F4A7C15ULL;
+            BucketPtr bucket = findOrCreate(key, overflowKey, *rule, nowMs);
+            int64_t waitMs = bucket->tokens.consume(capacityOf(*rule), rule->ratePerSecond, nowMs);
+            if (waitMs == 0)
+            {
+                return kContinue;
+            }
+
+            // 令牌不足，直接应答429，告诉客户端至少等多久再重试
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            LOG_DEBUG << "Rate limited " << request.peerIp() << " " << request.path();
+            response.setStatusLine(request.getVersion(), HttpResponse::k429TooManyRequests, "Too Many Requests");
+            response.setCloseConnection(false);
+            response.addHeader("Retry-After", std::to_string((waitMs + 999) / 1000));
+            response.setContentType("application/json");
+            response.setContentLength(tooManyBody_.size());
+            response.setBody(tooManyBody_);
+            return kRespond;
+        }
+
+        size_t RateLimitMiddleware::bucketCount() const
+        {
+            size_t count = 0;
+            for (auto &shard : shards_)
+            {
+                std::lock_guard<std::mutex> lock(const_cast<std::mutex &>(shard.mutex));
+                count += shard.buckets.size();
+            }
+            return count;
+        }
+
+        const RateLimitRule *RateLimitMiddleware::matchRule(const std::string &path) const
+        {
+            auto it = ruleIndex_.find(path);
+            if (it != ruleIndex_.end())
+            {
+                return &config_.rules[it->second];
+            }
+            return &config_.defaultRule;
+        }
+
+        uint64_t RateLimitMiddleware::bucketKey(size_t ruleIndex, const RateLimitRule &rule, const HttpRequest &request) const
+        {
+            std::string_view id;
+            uint64_t type = RateLimitRule::kPeerIp;
+            if (rule.keyType == RateLimitRule::kSession && config_.sessionValidator)
+            {
+                // 只认服务端存在的会话，否则客户端每次换一个cookie就能拿到一个新的满桶
+                id = sessionIdOf(request.getHeader(HttpHeaders::kCookie));
+                if (!id.empty() && config_.sessionValidator(std::string(id)))
+                    type = RateLimitRule::kSession;
+                else
+                    id = std::string_view();
+            }
+            if (id.empty())
+            {
+                id = request.peerIp();
+            }
+            // 哈希值混入规则编号和key类型，避免不同规则、IP和会话之间共用一个桶
+            uint64_t h = std::hash<std::string_view>{}(id);
+            h ^= (static_cast<uint64_t>(ruleIndex) << 2 | type) * 0x9E3779B97F4A7C15ULL;
+            return h;
+        }
+
+        RateLimitMiddleware::BucketPtr RateLimitMiddleware::findOrCreate(uint64_t key, uint64_t overflowKey, const RateLimitRule &rule, int64_t nowMs)
+        {
+            uint64_t tick = currentTick_.load(std::memory_order_relaxed);
+            Shard &shard = shardFor(key);
+            BucketPtr bucket;
+            bool created = false;
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto it = shard.buckets.find(key);
+                if (it == shard.buckets.end() && shard.buckets.size() >= maxBucketsPerShard_)
+                {
+                    // 分片已满（大量不同的客户端，或者伪造的来源），新客户端在本分片内共用一个桶，溢出桶不受上限限制
+                    // 调整低位使溢出桶仍然落在本分片，回收时才能找到
+                    key = overflowKey - overflowKey % kShardCount + key % kShardCount;
+                    it = shard.buckets.find(key);
+                }
+                if (it != shard.buckets.end())
+                {
+                    bucket = it->second;
+                }
+                else
+                {
+                    // 新桶是满的
+                    bucket = std::make_shared<Bucket>(capacityOf(rule), nowMs, tick);
+                    shard.buckets.emplace(key, bucket);
+                    created = true;
+                }
+            }
+
+            if (created)
+            {
+                // 释放分片锁之后再加时间轮的锁，与advanceWheel的加锁顺序（先时间轮后分片）不冲突
+                std::lock_guard<std::mutex> lock(wheelMutex_);
+                wheel_.schedule(key, static_cast<size_t>(config_.idleSeconds));
+            }
+            else if (bucket->lastSeenTick.load(std::memory_order_relaxed) != tick)
+            {
+                // 惰性续期：只记录最后活跃的刻度，同一刻度内不重复写
+                bucket->lastSeenTick.store(tick, std::memory_order_relaxed);
+            }
+            return bucket;
+        }
+
+        void RateLimitMiddleware::advanceWheel(int64_t nowMs)
+        {
+            if (nowMs < nextTickMs_.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            // 同一时刻只需要一个线程推进时间轮，其他线程直接跳过
+            std::unique_lock<std::mutex> lock(wheelMutex_, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                return;
+            }
+
+            const uint64_t idleTicks = static_cast<uint64_t>(std::max(config_.idleSeconds, 1));
+            int64_t next = nextTickMs_.load(std::memory_order_relaxed);
+            // 长时间没有请求时，最多转一整圈就足以处理所有到期的槽
+            for (size_t i = 0; next <= nowMs && i <= wheel_.maxTicks(); i++, next += kTickMs)
+            {
+                wheel_.tick([this, idleTicks](uint64_t key) {
+                    Shard &shard = shardFor(key);
+                    std::lock_guard<std::mutex> shardLock(shard.mutex);
+                    auto it = shard.buckets.find(key);
+                    if (it == shard.buckets.end())
+                    {
+                        return;
+                    }
+                    uint64_t lastSeen = it->second->lastSeenTick.load(std::memory_order_relaxed);
+                    uint64_t idle = wheel_.now() > lastSeen ? wheel_.now() - lastSeen : 0;
+                    if (idle >= idleTicks)
+                    {
+                        shard.buckets.erase(it);
+                    }
+                    else
+                    {
+                        wheel_.schedule(key, static_cast<size_t>(idleTicks - idle));
+                    }
+                });
+            }
+            if (next <= nowMs)
+            {
+                next = nowMs + kTickMs;
+            }
+            nextTickMs_.store(next, std::memory_order_relaxed);
+            currentTick_.store(wheel_.now(), std::memory_order_relaxed);
+        }
+
+        int64_t RateLimitMiddleware::elapsedMs() const
+        {
+            return steadyNowMs() - startMs_;
+        }
+
+    } // namespace middleware
+} // namespace http
@@ -14,7 +14,7 @@ namespace http{
             callbacks_[key] = std::move(callback);
         }
 
-        bool Router::route(const HttpRequest &req,HttpResponse *resp){
+        bool Router::route(HttpRequest &req,HttpResponse *resp){
             RouteKey key{req.method(),req.path()};
 
             //查找处理器
@@ -34,14 +34,12 @@ namespace http{
             //查找动态路由器
             for(const auto &[method,pathRegex,handler]:regexHandlers_){
                 std::smatch match;
-                std::string pathStr(req.path());
                 //如果方法匹配，并且动态路由匹配，则执行处理器
-                if(method == req.method() && std::regex_match(pathStr,match,pathRegex)){
-                    HttpRequest newReq(req);
-                    //因为extractPathParameters会在req里面添加路径参数，为了不直接修改原来的，所以复制一个
-                    extractPathParameters(match,newReq);
+                if(method == req.method() && std::regex_match(req.path(),match,pathRegex)){
+                    //路径参数直接写入请求对象，请求对象属于本次请求的上下文，不需要再复制一份
+                    extractPathParameters(match,req);
 
-                    handler->handle(newReq,resp);
+                    handler->handle(req,resp);
                     return true;
                 }
             }
@@ -49,12 +47,9 @@ namespace http{
             //查找动态路由回调函数
             for(const auto &[method,pathRegex,callback]:regexCallbacks_){
                 std::smatch match;
-                std::string pathStr(req.path());
                 //如果方法匹配，并且动态路由匹配，则执行处理器
-                if(method == req.method() && std::regex_match(pathStr,match,pathRegex)){
-                    HttpRequest newReq(req);
-                    //因为extractPathParameters会在req里面添加路径参数，为了不直接修改原来的，所以复制一个
-                    extractPathParameters(match,newReq);
+                if(method == req.method() && std::regex_match(req.path(),match,pathRegex)){
+                    extractPathParameters(match,req);
 
                     callback(req,resp);
                     return true;
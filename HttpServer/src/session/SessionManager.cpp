@@ -71,7 +71,7 @@ namespace http
         std::string SessionManager::getSessionIdFromCookie(const HttpRequest &req)
         {
             std::string sessionId;
-            std::string cookie = req.getHeader("Cookie");
+            const std::string &cookie = req.getHeader(HttpHeaders::kCookie);
 
             if (!cookie.empty())
             {
@@ -97,7 +97,7 @@ namespace http
         {
             // 设置会话id到响应头中，作为cookie
             std::string cookie = "sessionId=" + sessionId + "; Path=/; HttpOnly";
-            resp->addHeader("Set-Cookie", cookie);
+            resp->addHeader(HttpHeaders::kSetCookie, cookie);
         }
 
     } // namespace session
@@ -6,6 +6,8 @@ namespace http
 {
     namespace db
     {
+        std::atomic<uint64_t> DbConnection::stmtCacheHits_(0);
+        std::atomic<uint64_t> DbConnection::stmtCacheMisses_(0);
 
         DbConnection::DbConnection(const std::string &host,
                                    const std::string &user,
@@ -22,13 +24,16 @@ namespace http
                     conn_->setSchema(database_); // 设定具体数据库
 
                     // 设置连接属性
-                    conn_->setClientOption("OPT_RECONNECT", "true");
+                    // 关闭驱动的自动重连：它会悄悄换成新会话，丢掉事务和LAST_INSERT_ID()，重连由本类在可以安全重试时进行
+                    bool autoReconnect = false;
+                    conn_->setClientOption("OPT_RECONNECT", &autoReconnect);
                     conn_->setClientOption("OPT_CONNECT_TIMEOUT", "10");
                     conn_->setClientOption("multi_statements", "false");
 
                     // 设置字符集
                     std::unique_ptr<sql::Statement> stmt(conn_->createStatement());
                     stmt->execute("SET NAMES utf8mb4"); // 执行一条sql指令SET
+                    markValidated();
 
                     LOG_INFO << "Database connection established";
                 }
@@ -55,11 +60,14 @@ namespace http
 
         bool DbConnection::ping()
         {
+            // 加锁，避免和借出该连接的线程同时使用底层连接
+            std::lock_guard<std::mutex> lock(mutex_);
             try
             {
                 // 不使用getStmt，直接创建新的语句
                 std::unique_ptr<sql::Statement> stmt(conn_->createStatement());
                 std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery("SELECT 1"));
+                markValidated();
                 return true;
             }
             catch (const sql::SQLException &e)
@@ -87,6 +95,14 @@ namespace http
 
         void DbConnection::reconnect()
         {
+            std::lock_guard<std::mutex> lock(mutex_);
+            reconnectLocked();
+        }
+
+        void DbConnection::reconnectLocked()
+        {
+            // 旧连接上prepare的语句在新连接上不可用
+            clearStatementCache();
             try
             {
                 if (conn_)
@@ -99,6 +115,7 @@ namespace http
                     conn_.reset(driver->connect(host_, user_, password_));
                     conn_->setSchema(database_);
                 }
+                markValidated();
             }
             catch (const sql::SQLException &e)
             {
@@ -112,6 +129,7 @@ namespace http
             std::lock_guard<std::mutex> lock(mutex_);
             try
             {
+                clearStatementCache();
                 if (conn_)
                 {
                     // 确保所有事务都已完成
@@ -138,7 +156,7 @@ namespace http
                 LOG_WARN << "Error cleaning up connection: " << e.what();
                 try
                 {
-                    reconnect();
+                    reconnectLocked();
                 }
                 catch (...)
                 {
@@ -147,5 +165,46 @@ namespace http
             }
         }
 
+        sql::PreparedStatement *DbConnection::getCachedStatement(const std::string &sql)
+        {
+            auto it = stmtIndex_.find(sql);
+            if (it != stmtIndex_.end())
+            {
+                // 命中，移到表头
+                stmtLru_.splice(stmtLru_.begin(), stmtLru_, it->second);
+                stmtCacheHits_.fetch_add(1, std::memory_order_relaxed);
+                return it->second->second.get();
+            }
+
+            stmtCacheMisses_.fetch_add(1, std::memory_order_relaxed);
+            std::unique_ptr<sql::PreparedStatement> stmt(conn_->prepareStatement(sql));
+            stmtLru_.emplace_front(sql, std::move(stmt));
+            stmtIndex_[sql] = stmtLru_.begin();
+
+            // 超出容量，淘汰最久未使用的语句
+            if (stmtLru_.size() > kStmtCacheCapacity)
+            {
+                stmtIndex_.erase(stmtLru_.back().first);
+                stmtLru_.pop_back();
+            }
+            return stmtLru_.front().second.get();
+        }
+
+        void DbConnection::dropCachedStatement(const std::string &sql)
+        {
+            auto it = stmtIndex_.find(sql);
+            if (it != stmtIndex_.end())
+            {
+                stmtLru_.erase(it->second);
+                stmtIndex_.erase(it);
+            }
+        }
+
+        void DbConnection::clearStatementCache()
+        {
+            stmtIndex_.clear();
+            stmtLru_.clear();
+        }
+
     } // namespace db
 } // namespace http
\ No newline at end of file
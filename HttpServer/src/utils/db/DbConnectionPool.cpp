@@ -10,7 +10,7 @@ namespace http
                                     const std::string &user,
                                     const std::string &password,
                                     const std::string &database,
-                                    size_t poolSize)
+                                    const DbPoolConfig &config)
         {
             // 连接池会被多个线程访问，因此加锁
             std::lock_guard<std::mutex> lock(mutex_);
@@ -24,15 +24,22 @@ namespace http
             user_ = user;
             password_ = password;
             database_ = database;
+            config_ = config;
+            if (config_.maxSize < config_.minSize)
+                config_.maxSize = config_.minSize;
+            if (config_.maxSize == 0)
+                config_.maxSize = 1;
 
-            // 创建连接
-            for (size_t i = 0; i < poolSize; i++)
+            // 先创建常驻连接，其余的按需创建
+            for (size_t i = 0; i < config_.minSize; i++)
             {
-                connections_.push(createConnection());
+                connections_.push_back({createConnection(), Clock::now()});
+                total_++;
             }
 
             initialized_ = true;
-            LOG_INFO << "Database connection pool initialized with " << poolSize << "connections";
+            LOG_INFO << "Database connection pool initialized with " << config_.minSize
+                     << " connections (max " << config_.maxSize << ")";
         }
 
         DbConnectionPool::DbConnectionPool()
@@ -44,63 +51,122 @@ namespace http
         DbConnectionPool::~DbConnectionPool()
         {
             std::lock_guard<std::mutex> lock(mutex_);
-            while (!connections_.empty())
-            {
-                connections_.pop();
-            }
+            connections_.clear();
             LOG_INFO << "Database connection pool destroyed";
         }
 
-        // 修改获取连接的函数
         std::shared_ptr<DbConnection> DbConnectionPool::getConnection()
         {
-            std::shared_ptr<DbConnection> conn;
+            Clock::time_point start = Clock::now();
+            Clock::time_point deadline = start + std::chrono::milliseconds(config_.acquireTimeoutMs);
             { // 下面上锁
                 std::unique_lock<std::mutex> lock(mutex_);
+                if (!initialized_)
+                {
+                    throw DbException("Connection pool not initialized");
+                }
 
-                // 当连接池空的时候要等
-                while (connections_.empty())
+                while (connections_.empty() && total_ >= config_.maxSize)
                 {
-                    if (!initialized_)
+                    // 连接都已借出且达到上限，有限时间内等待归还，超时快速失败，避免拖住IO线程
+                    waiting_++;
+                    bool ready = cv_.wait_until(lock, deadline, [this] {
+                        return !connections_.empty() || total_ < config_.maxSize;
+                    });
+                    waiting_--;
+                    if (!ready)
                     {
-                        throw DbException("Connection pool not initialized");
+                        timeouts_++;
+                        recordWait(Clock::now() - start);
+                        LOG_WARN << "Timed out waiting for database connection, total: " << total_
+                                 << ", waiting: " << waiting_;
+                        throw DbException("Timed out waiting for database connection");
                     }
-                    LOG_INFO << "Waiting for available connection...";
-                    cv_.wait(lock); // 释放锁阻塞线程
                 }
-                conn = connections_.front();
-                connections_.pop();
+
+                if (!connections_.empty())
+                {
+                    // 取最近归还的连接，长时间用不到的连接留在队头等待回收
+                    std::shared_ptr<DbConnection> conn = std::move(connections_.back().conn);
+                    connections_.pop_back();
+                    acquired_++;
+                    recordWait(Clock::now() - start);
+                    lock.unlock();
+                    return lend(std::move(conn));
+                }
+
+                // 没有空闲连接但还没到上限，占一个名额后在锁外创建新连接
+                total_++;
             } // 释放锁
+
             try
             {
-                // 在锁外检查连接
-                if (!conn->ping())
+                std::shared_ptr<DbConnection> conn = createConnection();
+                size_t total;
                 {
-                    LOG_WARN << "Connection lost, attempting to reconnect...";
-                    conn->reconnect();
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    acquired_++;
+                    recordWait(Clock::now() - start);
+                    total = total_;
                 }
-
-                return std::shared_ptr<DbConnection>(conn.get(),
-                                                     [this, conn](DbConnection *)
-                                                     {
-                                                         std::lock_guard<std::mutex> lock(mutex_);
-                                                         connections_.push(conn);
-                                                         cv_.notify_one();
-                                                     });
-                // 这个智能指针接收两个参数，一个是conn.get()返回的裸指针
-                // 一个是lambda表达式，作为deleter，在shared_ptr中，会维护一个计数器，引用计数归零时，用deleter清除
-                // 捕获this是便于使用DbConnectionPool的对象，使用类内成员
+                LOG_INFO << "Database connection pool grew to " << total << " connections";
+                return lend(std::move(conn));
             }
             catch (const std::exception &e)
             {
                 LOG_ERROR << "Failed to get Connection: " << e.what();
                 {
                     std::lock_guard<std::mutex> lock(mutex_);
-                    connections_.push(conn);
-                    cv_.notify_one();
+                    total_--;
                 }
-                throw; // 在catch里面重新抛出捕获的异常，这里是回收连接之后再次抛出给上层
+                cv_.notify_one();
+                throw; // 在catch里面重新抛出捕获的异常，把名额归还之后再次抛出给上层
+            }
+        }
+
+        std::shared_ptr<DbConnection> DbConnectionPool::lend(std::shared_ptr<DbConnection> conn)
+        {
+            DbConnection *raw = conn.get();
+            return std::shared_ptr<DbConnection>(raw,
+                                                 [this, conn](DbConnection *) mutable
+                                                 {
+                                                     release(std::move(conn));
+                                                 });
+            // 这个智能指针接收两个参数，一个是conn.get()返回的裸指针
+            // 一个是lambda表达式，作为deleter，在shared_ptr中，会维护一个计数器，引用计数归零时，用deleter清除
+            // 捕获this是便于使用DbConnectionPool的对象，使用类内成员
+        }
+
+        void DbConnectionPool::release(std::shared_ptr<DbConnection> conn)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                connections_.push_back({std::move(conn), Clock::now()});
             }
+            cv_.notify_one();
+        }
+
+        DbPoolStats DbConnectionPool::stats()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            DbPoolStats s;
+            s.total = total_;
+            s.idle = connections_.size();
+            s.waiting = waiting_;
+            s.acquired = acquired_;
+            s.timeouts = timeouts_;
+            s.waitHistogram = waitHistogram_;
+            return s;
+        }
+
+        // 需持有mutex_
+        void DbConnectionPool::recordWait(Clock::duration waited)
+        {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(waited).count();
+            size_t bucket = 0;
+            while (bucket < DbPoolStats::kWaitBucketsMs.size() && ms >= DbPoolStats::kWaitBucketsMs[bucket])
+                bucket++;
+            waitHistogram_[bucket]++;
         }
 
         // 创建一个 DbConnection 对象，并用 shared_ptr 管理它。
@@ -110,6 +176,51 @@ namespace http
             return std::make_shared<DbConnection>(host_, user_, password_, database_);
         }
 
+        void DbConnectionPool::shrinkIdle()
+        {
+            std::vector<std::shared_ptr<DbConnection>> expired; // 在锁外析构，关闭连接可能比较慢
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Clock::time_point deadline = Clock::now() - std::chrono::seconds(config_.idleTimeoutSeconds);
+                // 队头是最久没用过的连接
+                while (total_ > config_.minSize && !connections_.empty() &&
+                       connections_.front().lastUsed < deadline)
+                {
+                    expired.push_back(std::move(connections_.front().conn));
+                    connections_.pop_front();
+                    total_--;
+                }
+            }
+            if (!expired.empty())
+            {
+                LOG_INFO << "Database connection pool shrank by " << expired.size() << " idle connections";
+            }
+        }
+
+        void DbConnectionPool::ensureMinSize()
+        {
+            while (true)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!initialized_ || total_ >= config_.minSize)
+                        return;
+                    total_++;
+                }
+                try
+                {
+                    release(createConnection());
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR << "Failed to refill connection pool: " << e.what();
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    total_--;
+                    return;
+                }
+            }
+        }
+
         // 修改检查连接的函数
         void DbConnectionPool::checkConnections()
         {
@@ -117,33 +228,42 @@ namespace http
             {
                 try
                 {
+                    shrinkIdle();
+                    ensureMinSize();
 
-                    std::vector<std::shared_ptr<DbConnection>> connsToCheck;
-                    { // 上锁，进行拷贝，拷贝下来再检查，防止长时间持锁检查
+                    std::vector<IdleConnection> connsToCheck;
+                    { // 上锁，把需要检查的空闲连接从池中取出，检查期间不会被借走，防止长时间持锁检查
                         std::unique_lock<std::mutex> lock(mutex_);
                         if (connections_.empty())
                         {
                             // 如果连接池是空的，缓1秒再进行下一轮，避免一直查询，进入忙等
+                            lock.unlock();
                             std::this_thread::sleep_for(std::chrono::seconds(1));
                             continue;
                         }
 
-                        auto temp = connections_;
-                        while (!temp.empty())
-                        { // 把连接池里面所有连接复制给ConnsToCheck
-                            connsToCheck.push_back(temp.front());
-                            temp.pop();
+                        // 借出的连接不在空闲队列中，不会被检查：借用者可能正在读流式结果集，ping会打乱协议
+                        // 最近确认过可用的连接跳过
+                        for (auto it = connections_.begin(); it != connections_.end();)
+                        {
+                            if (it->conn->validatedWithin(kValidateIntervalSeconds))
+                            {
+                                ++it;
+                                continue;
+                            }
+                            connsToCheck.push_back(std::move(*it));
+                            it = connections_.erase(it);
                         }
                     } // 释放锁
 
                     // 在锁外检查连接
-                    for (auto &conn : connsToCheck)
+                    for (auto &idle : connsToCheck)
                     {
-                        if (!conn->ping())
+                        if (!idle.conn->ping())
                         {
                             try
                             {
-                                conn->reconnect();
+                                idle.conn->reconnect();
                             }
                             catch (const std::exception &e)
                             {
@@ -151,7 +271,19 @@ namespace http
                             }
                         }
                     }
-                    std::this_thread::sleep_for(std::chrono::seconds(60));
+                    if (!connsToCheck.empty())
+                    {
+                        // 放回队头，保持按最后使用时间排序，不影响空闲回收的顺序
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            for (auto it = connsToCheck.rbegin(); it != connsToCheck.rend(); ++it)
+                            {
+                                connections_.push_front(std::move(*it));
+                            }
+                        }
+                        cv_.notify_all();
+                    }
+                    std::this_thread::sleep_for(std::chrono::seconds(kCheckIntervalSeconds));
                 }
                 catch (const std::exception &e)
                 {
@@ -162,4 +294,4 @@ namespace http
         }
 
     } // namespace db
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -0,0 +1,52 @@
+#include "../../../include/utils/db/DbExecutor.h"
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+    namespace db
+    {
+        DbExecutor::~DbExecutor()
+        {
+            stop();
+        }
+
+        void DbExecutor::stop()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!started_)
+            {
+                return;
+            }
+            pool_.stop();
+            started_ = false;
+            LOG_INFO << "DbExecutor stopped";
+        }
+
+        void DbExecutor::start(int numThreads)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (started_)
+            {
+                return;
+            }
+            // 队列不设上限，run()不会阻塞提交任务的IO线程
+            // 线程数等于连接池上限，任务取连接不会等待，排队时间也就没有上限；
+            // 队列长度由每个EventLoop处理中请求数的上限(ServerLimits::maxInFlightPerLoop)间接限制
+            pool_.setMaxQueueSize(0);
+            pool_.start(numThreads);
+            started_ = true;
+            LOG_INFO << "DbExecutor started with " << numThreads << " threads";
+        }
+
+        void DbExecutor::run(Task task)
+        {
+            if (!started_)
+            {
+                task();
+                return;
+            }
+            pool_.run(std::move(task));
+        }
+
+    } // namespace db
+} // namespace http
@@ -8,7 +8,10 @@
 #include <vector>
 #include <mutex>
 
+#include "LineScanner.h"
+
 const int BOARD_SIZE = 15;
+static_assert(BOARD_SIZE == PackedBoard::kSize, "PackedBoard must match BOARD_SIZE");
 
 const std::string EMPTY = "empty";
 const std::string AI_PLAYER = "white";   // AI玩家白棋
@@ -32,6 +35,12 @@ public:
 
     void aiMove();
 
+    // 锁住当前对局的回合，同一局棋的人类落子和AI应手必须串行执行
+    std::unique_lock<std::mutex> lockTurn()
+    {
+        return std::unique_lock<std::mutex>(turnMutex_);
+    }
+
     // 获取最后一步移动的坐标
     std::pair<int, int> getLastMove() const 
     {
@@ -46,6 +55,13 @@ public:
         return board_; 
     }
 
+    // 获取位棋盘，供二进制协议按位打包棋盘
+    const PackedBoard& getPackedBoard() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return packed_;
+    }
+
     bool isGameOver() const 
     { 
         std::lock_guard<std::mutex> lock(mutex_);
@@ -76,8 +92,6 @@ private:
 
     // 获取AI的最佳移动位置
     std::pair<int, int> getBestMove();
-    // 评估威胁 
-    int evaluateThreat(int r, int c);
     // 判断某个空位是否靠近已有棋子
     bool isNearOccupied(int r, int c);
 
@@ -88,5 +102,7 @@ private:
     std::string                           winner_{"none"};
     std::pair<int, int>                   lastMove_{-1, -1};  // 上一次落子位置
     std::vector<std::vector<std::string>> board_;
+    PackedBoard                           packed_;  // 与board_同步的位棋盘，用于快速扫描
     mutable std::mutex                    mutex_;  // 添加互斥锁
+    std::mutex                            turnMutex_;  // 回合锁，见lockTurn()
 };
\ No newline at end of file
@@ -0,0 +1,99 @@
+// 密码哈希服务：用scrypt保存和校验密码，计算放在专用的CPU线程池中，不占用IO线程和数据库线程
+// 线程池的等待队列有上限，队列满时立即拒绝（由调用方返回503），避免登录洪峰把请求无限堆积
+// 存储格式：$scrypt$ln=<log2(N)>,r=<r>,p=<p>$<盐(hex)>$<哈希(hex)>
+// 不是这种格式的旧记录按明文密码处理，登录成功后由调用方升级成scrypt哈希
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CredentialConfig
+{
+    int      threads = 2;        // 哈希线程数，建议不超过CPU核数的一半
+    size_t   maxQueueSize = 256; // 等待中的任务上限，超过后拒绝
+    uint32_t costLog2 = 14;      // scrypt的N = 2^costLog2，每次哈希约占用 128 * r * N 字节内存
+    uint32_t blockSize = 8;      // scrypt的r
+    uint32_t parallelism = 1;    // scrypt的p
+
+    static CredentialConfig defaultConfig() { return CredentialConfig(); }
+};
+
+class CredentialService
+{
+public:
+    // 哈希失败时hash为空
+    using HashCallback = std::function<void(const std::string& hash)>;
+    using VerifyCallback = std::function<void(bool matched)>;
+
+    // 单例模式
+    static CredentialService& getInstance()
+    {
+        static CredentialService instance;
+        return instance;
+    }
+
+    void start(const CredentialConfig& config = CredentialConfig::defaultConfig());
+    void stop();
+
+    // 把计算提交到哈希线程池，回调在哈希线程中执行
+    // 队列已满或服务未启动时返回false，回调不会被调用
+    // 停止服务时还没开始计算的任务以失败结果（空哈希 / 不匹配）在调用stop()的线程中回调
+    bool hashAsync(const std::string& password, HashCallback cb);
+    bool verifyAsync(const std::string& password, const std::string& stored, VerifyCallback cb);
+
+    // 同步版本，只应在哈希线程中调用
+    std::string hash(const std::string& password) const;
+    bool verify(const std::string& password, const std::string& stored) const;
+    // 旧的明文记录，或者成本参数低于当前配置的哈希，需要重新计算
+    bool needsRehash(const std::string& stored) const;
+
+    size_t queueSize() const;
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+    CredentialService() = default;
+    ~CredentialService();
+
+    // 禁止拷贝构造
+    CredentialService(const CredentialService&) = delete;
+    CredentialService& operator=(const CredentialService&) = delete;
+
+    struct Params
+    {
+        uint32_t costLog2;
+        uint32_t blockSize;
+        uint32_t parallelism;
+    };
+
+    // run在哈希线程中执行；cancel在停止时还没轮到执行的任务上调用，用于以失败结果回调
+    struct Task
+    {
+        std::function<void()> run;
+        std::function<void()> cancel;
+    };
+
+    bool submit(Task task);
+    void workerLoop();
+    // 解析存储的哈希，不是scrypt格式返回false
+    static bool parse(const std::string& stored, Params& params, std::string& salt, std::string& key);
+    // 按参数计算一次所需的内存(字节)
+    static uint64_t memoryCost(const Params& params);
+    static bool derive(const std::string& password, const std::string& salt, const Params& params,
+                       unsigned char* out, size_t outLen);
+
+private:
+    CredentialConfig                  config_;
+    std::vector<std::thread>          workers_;
+    std::deque<Task>                  queue_;
+    mutable std::mutex                mutex_;
+    std::condition_variable           cv_;
+    bool                              running_ = false;
+    std::atomic<uint64_t>             rejected_{0};
+};
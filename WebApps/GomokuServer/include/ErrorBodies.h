@@ -0,0 +1,50 @@
+// 固定内容的错误响应体，第一次使用时渲染一次，之后直接复用
+#pragma once
+
+#include <string>
+
+#include "../../../HttpServer/include/utils/JsonWriter.h"
+
+class ErrorBodies
+{
+public:
+    static const std::string& unauthorized()
+    {
+        static const std::string body = JsonWriter::errorBody("Unauthorized");
+        return body;
+    }
+
+    static const std::string& invalidCredentials()
+    {
+        static const std::string body = JsonWriter::errorBody("Invalid username or password");
+        return body;
+    }
+
+    static const std::string& usernameExists()
+    {
+        static const std::string body = JsonWriter::errorBody("username already exists");
+        return body;
+    }
+
+    static const std::string& invalidMove()
+    {
+        static const std::string body = JsonWriter::errorBody("Invalid move");
+        return body;
+    }
+
+    static const std::string& serverBusy()
+    {
+        static const std::string body = JsonWriter::errorBody("Server busy, please retry later");
+        return body;
+    }
+
+    static const std::string& alreadyLoggedIn()
+    {
+        static const std::string body = [] {
+            std::string s;
+            JsonWriter(&s).beginObject().field("success", false).field("error", "账号已在其他地方登录").endObject();
+            return s;
+        }();
+        return body;
+    }
+};
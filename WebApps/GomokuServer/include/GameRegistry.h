@@ -0,0 +1,60 @@
+// 对局注册表：userId -> AiGame
+// 按userId分片，每个分片一把锁，不同用户的请求基本不会互相竞争
+// 同一局棋的落子由AiGame::lockTurn()串行化，注册表本身只负责查找、创建、删除和空闲回收
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "AiGame.h"
+#include "ShardIndex.h"
+
+class GameRegistry
+{
+public:
+    using GamePtr = std::shared_ptr<AiGame>;
+
+    // 获取对局，不存在时创建，同时刷新最近活跃时间
+    GamePtr getOrCreate(int userId);
+    // 获取对局，不存在返回nullptr
+    GamePtr find(int userId);
+    // 丢弃旧对局，重新开始一局
+    GamePtr reset(int userId);
+    // 删除对局
+    void erase(int userId);
+    // 只有当前登记的仍是game时才删除，避免误删用户刚刚重开的新对局
+    void erase(int userId, const GamePtr& game);
+
+    // 回收超过idleSeconds没有操作的对局，返回回收数量
+    size_t evictIdle(int idleSeconds);
+
+    size_t size() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        GamePtr           game;
+        Clock::time_point lastActive;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex                 mutex;
+        std::unordered_map<int, Entry>     games;
+    };
+
+    static const size_t kShardCount = 64; // 必须是2的幂
+
+    Shard& shardFor(int userId)
+    {
+        return shards_[shardIndex<kShardCount>(userId)];
+    }
+
+private:
+    Shard shards_[kShardCount];
+};
@@ -8,6 +8,11 @@
 
 
 #include "AiGame.h"
+#include "CredentialService.h"
+#include "ErrorBodies.h"
+#include "GameRegistry.h"
+#include "PresenceTracker.h"
+#include "StatsCache.h"
 #include "../../../HttpServer/include/http/HttpServer.h"
 #include "../../../HttpServer/include/utils/MysqlUtil.h"
 #include "../../../HttpServer/include/utils/FileUtil.h"
@@ -28,6 +33,11 @@ class GameBackendHandler;
 
 #define MAX_AIBOT_NUM 4096
 
+// 对局超过这么久没有落子就回收（秒）
+#define AI_GAME_IDLE_TIMEOUT 1800
+// 用户超过这么久没有任何操作就视为下线（秒）
+#define USER_IDLE_TIMEOUT 3600
+
 class GomokuServer
 {
 public:
@@ -36,12 +46,20 @@ public:
                  muduo::net::TcpServer::Option option = muduo::net::TcpServer::kNoReusePort);
 
     void setThreadNum(int numThreads);
+    // 每个IO线程各自监听端口，需要以kReusePort构造
+    void setReusePortListeners(bool on);
+    void setCpuAffinity(bool on);
+    // 重启时通过该路径交接监听套接字，新旧进程使用同一路径
+    void setHandoffPath(const std::string& path);
+    // 运行到优雅退出完成为止
     void start();
 private:
     void initialize();
     void initializeSession();
     void initializeRouter();
     void initializeMiddleware();
+    void initializeOpeningBook();
+    void initializeTimers();
     
     void setSessionManager(std::unique_ptr<http::session::SessionManager> manager)
     {
@@ -63,31 +81,19 @@ private:
     // 获取历史最高在线人数
     int getMaxOnline() const
     {
-        return maxOnline_.load();
+        return onlineUsers_.peak();
     }
 
     // 获取当前在线人数
     int getCurOnline() const
     {
-        return onlineUsers_.size();
-    }
-
-    void updateMaxOnline(int online)
-    {
-        maxOnline_ = std::max(maxOnline_.load(), online);
+        return onlineUsers_.current();
     }
 
-    // 获取用户总数
-    int getUserCount()
+    // 获取用户总数（缓存值，不访问数据库）
+    int getUserCount() const
     {
-        std::string sql = "SELECT COUNT(*) as count FROM users";
-
-        sql::ResultSet* res = mysqlUtil_.executeQuery(sql);
-        if (res->next())
-        {
-            return res->getInt("count");
-        }
-        return 0;
+        return statsCache_.userCount();
     }
     
 private:
@@ -112,11 +118,9 @@ private:
     http::HttpServer                                 httpServer_;
     http::MysqlUtil                                  mysqlUtil_;
     // userId -> AiBot
-    std::unordered_map<int, std::shared_ptr<AiGame>> aiGames_;
-    std::mutex                                       mutexForAiGames_;
-    // userId -> 是否在游戏中
-    std::unordered_map<int, bool>                    onlineUsers_;
-    std::mutex                                       mutexForOnlineUsers_; 
-    // 最高在线人数
-    std::atomic<int>                                 maxOnline_;
+    GameRegistry                                     aiGames_;
+    // 在线用户及当前、最高在线人数
+    PresenceTracker                                  onlineUsers_;
+    // 后台统计数据
+    StatsCache                                       statsCache_;
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+// 基于位棋盘的连线扫描：胜负判定、必胜/必防点搜索、威胁评估
+// 棋盘按行、列、主对角线、副对角线压缩成16位掩码，一条SIMD指令可以同时处理多条线
+// 提供标量、SSE2、AVX2三套实现，运行时根据CPU特性选择
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// 压缩棋盘：每个玩家的每条线用一个uint16_t表示，第i位为1表示线上第i格有子
+// 线的编号：[0, 15)行  [15, 30)列  [30, 59)主对角线(x - y)  [59, 88)副对角线(x + y)
+// 对角线上统一以y作为位序号，保证线上相邻的格子在掩码里也相邻
+class PackedBoard
+{
+public:
+    static const int kSize = 15;
+    static const int kRowBase = 0;
+    static const int kColBase = 15;
+    static const int kDiagBase = 30;
+    static const int kAntiDiagBase = 59;
+    static const int kLines = 88;
+    static const int kLanes = 96; // 补齐到AVX2寄存器宽度(16 x uint16_t)的整数倍
+
+    enum Player
+    {
+        kHuman = 0,
+        kAi = 1
+    };
+
+    PackedBoard() { clear(); }
+
+    void clear() { std::memset(lines_, 0, sizeof(lines_)); }
+
+    void place(int x, int y, int player)
+    {
+        uint16_t* l = lines_[player];
+        l[kRowBase + x] |= static_cast<uint16_t>(1u << y);
+        l[kColBase + y] |= static_cast<uint16_t>(1u << x);
+        l[kDiagBase + x - y + kSize - 1] |= static_cast<uint16_t>(1u << y);
+        l[kAntiDiagBase + x + y] |= static_cast<uint16_t>(1u << y);
+    }
+
+    void remove(int x, int y, int player)
+    {
+        uint16_t* l = lines_[player];
+        l[kRowBase + x] &= static_cast<uint16_t>(~(1u << y));
+        l[kColBase + y] &= static_cast<uint16_t>(~(1u << x));
+        l[kDiagBase + x - y + kSize - 1] &= static_cast<uint16_t>(~(1u << y));
+        l[kAntiDiagBase + x + y] &= static_cast<uint16_t>(~(1u << y));
+    }
+
+    bool test(int x, int y, int player) const
+    {
+        return (lines_[player][kRowBase + x] >> y) & 1u;
+    }
+
+    const uint16_t* lines(int player) const { return lines_[player]; }
+
+private:
+    alignas(32) uint16_t lines_[2][kLanes];
+};
+
+class LineScanner
+{
+public:
+    // 一套扫描内核，所有掩码数组都按kLanes对齐
+    struct Kernels
+    {
+        const char* name;
+        // own中是否存在五连
+        bool (*hasFive)(const uint16_t* own);
+        // 计算每条线上落子即成五的空位，结果写入out[kLanes]
+        void (*winningMoves)(const uint16_t* own, const uint16_t* other, uint16_t* out);
+        // 威胁评估：humanRows为补零到32项的人类棋子行掩码，emptyRows为16项的空位行掩码
+        // 返回得分最高的空位 x * kSize + y（同分取行优先的第一个），没有空位返回-1
+        int (*bestThreat)(const uint16_t* humanRows, const uint16_t* emptyRows);
+    };
+
+    static const Kernels& scalar();
+    // 当前CPU或编译目标不支持时返回nullptr
+    static const Kernels* sse2();
+    static const Kernels* avx2();
+    // 运行时选择的最优实现
+    static const Kernels& active();
+
+    // 有效位掩码，每条线上实际存在的格子对应的位为1
+    static const uint16_t* validMask();
+
+    // 判断(x, y)所在的四条线上是否有经过该点的五连
+    static bool checkWin(const PackedBoard& board, int x, int y, int player);
+    // 落子即可成五的空位，按行掩码写入rows[kSize]
+    static void winningMoves(const PackedBoard& board, int player, uint16_t* rows);
+    // 威胁评估，返回得分最高的空位 x * kSize + y，棋盘已满返回-1
+    static int bestThreatMove(const PackedBoard& board);
+};
@@ -0,0 +1,58 @@
+// /aiBot/move 的响应编码
+// 客户端通过Accept头选择格式，没有声明或者都不支持时仍然返回原来的JSON
+//   application/json                  完整棋盘，"empty"/"black"/"white"字符串数组，约3KB
+//   application/vnd.gomoku.delta      只返回本回合的结果和AI的应手，固定6字节
+//   application/vnd.gomoku.board      结果 + 每格2位打包的棋盘，固定63字节
+// 二进制格式中所有字段都是单字节，不涉及字节序
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "LineScanner.h"
+
+class MoveCodec
+{
+public:
+    enum Format
+    {
+        kJson,
+        kDelta,
+        kPackedBoard
+    };
+
+    enum Winner : uint8_t
+    {
+        kNone = 0,
+        kHuman = 1,
+        kAi = 2,
+        kDraw = 3
+    };
+
+    static const uint8_t kVersion = 1;
+    static const uint8_t kNoMove = 0xFF;  // 没有AI应手时的坐标
+    static const size_t  kHeaderSize = 6; // version, winner, nextTurn, flags, lastX, lastY
+    static const size_t  kBoardBytes = (PackedBoard::kSize * PackedBoard::kSize * 2 + 7) / 8;
+
+    static const char* const kJsonType;
+    static const char* const kDeltaType;
+    static const char* const kBoardType;
+
+    // 本回合的结果
+    struct Outcome
+    {
+        Winner winner = kNone;
+        bool   humanNext = false; // 是否轮到人类落子，对局结束时为false
+        int    lastX = -1;        // AI的应手，AI没有落子时为-1
+        int    lastY = -1;
+    };
+
+    // 按Accept头协商响应格式，支持q值，q=0表示拒绝该类型，同q值按出现顺序
+    static Format negotiate(const std::string& accept);
+    static const char* contentType(Format format);
+
+    // 头部：version | winner | nextTurn(0: none 1: human) | flags(bit0: 附带棋盘) | lastX | lastY
+    static std::string encodeDelta(const Outcome& outcome);
+    // 头部之后是棋盘，按行优先每格2位(0: 空 1: 黑/人类 2: 白/AI)，每字节从低位开始存放4格
+    static std::string encodeBoard(const Outcome& outcome, const PackedBoard& board);
+};
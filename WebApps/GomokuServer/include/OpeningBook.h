@@ -0,0 +1,84 @@
+// 开局库：把常见开局局面的AI应手预先算好，存成紧凑的二进制文件，启动时mmap进内存
+// 局面经过8种对称变换(4种旋转 x 是否镜像)归一化后作为键，开局阶段的应手直接查表，不需要搜索
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class OpeningBook
+{
+public:
+    // 文件头，固定32字节
+    struct Header
+    {
+        char     magic[8];   // "GMKBOOK1"
+        uint32_t version;    // 文件格式版本，哈希方式变化时需要递增
+        uint32_t boardSize;  // 棋盘大小
+        uint64_t count;      // 记录条数
+        uint32_t maxStones;  // 开局库覆盖的最大棋子数，超过则不必查表
+        uint32_t reserved;
+    };
+
+    // 一条记录，固定16字节，文件中按key升序排列，便于二分查找
+    struct Entry
+    {
+        uint64_t key;      // 归一化局面的哈希值
+        uint8_t  x;        // 归一化局面下的应手坐标
+        uint8_t  y;
+        uint16_t stones;   // 局面中的棋子数，用于校验
+        uint32_t reserved;
+    };
+
+    // 单例模式
+    static OpeningBook& getInstance()
+    {
+        static OpeningBook instance;
+        return instance;
+    }
+
+    // mmap加载二进制开局库，文件不存在或格式不对返回false
+    bool load(const std::string& path);
+    // 把当前开局库写成二进制文件
+    bool save(const std::string& path) const;
+    // 由内置开局表生成开局库（存放在内存中）
+    void buildDefault();
+
+    // 查询当前局面的应手，命中时返回true，并通过x、y带回原局面下的坐标
+    bool lookup(const std::vector<std::vector<std::string>>& board, int& x, int& y) const;
+
+    size_t size() const { return count_; }
+
+private:
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    // 禁止拷贝构造
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    struct Stone
+    {
+        int x;
+        int y;
+        int color; // 0: 人类(黑棋) 1: AI(白棋)
+    };
+
+    // 第t种对称变换及其逆变换
+    static void transform(int t, int& x, int& y);
+    static void inverseTransform(int t, int& x, int& y);
+    // 计算局面的归一化哈希，并返回取到最小值的变换编号
+    static uint64_t canonicalKey(const std::vector<Stone>& stones, int& trans);
+
+    // 添加一条开局：局面stones下AI应手为(x, y)
+    void addLine(const std::vector<Stone>& stones, int x, int y);
+    void unmap();
+
+private:
+    const Entry*       entries_ = nullptr; // 指向mmap区域或者owned_
+    size_t             count_ = 0;
+    uint32_t           maxStones_ = 0;
+    std::vector<Entry> owned_;             // 由内置开局表生成时的存储
+    void*              mapped_ = nullptr;  // mmap映射的起始地址
+    size_t             mappedSize_ = 0;
+};
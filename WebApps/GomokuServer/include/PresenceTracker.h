@@ -0,0 +1,57 @@
+// 在线状态统计：记录哪些用户在线，以及当前、历史最高在线人数
+// 用户集合按userId分片加锁；人数用原子变量维护，读取时不需要加锁
+// 长时间没有活动的用户（直接关掉页面、没有走登出流程）由定时任务清理
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "ShardIndex.h"
+
+class PresenceTracker
+{
+public:
+    PresenceTracker() : current_(0), peak_(0) {}
+
+    // 用户上线，已经在线时返回false
+    bool login(int userId);
+    // 用户下线
+    void logout(int userId);
+    // 刷新最近活跃时间
+    void touch(int userId);
+    bool isOnline(int userId);
+
+    // 清理超过idleSeconds没有活动的用户，返回清理数量
+    size_t expireIdle(int idleSeconds);
+
+    // 当前在线人数
+    int current() const { return current_.load(std::memory_order_relaxed); }
+    // 历史最高在线人数
+    int peak() const { return peak_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Shard
+    {
+        std::mutex                                 mutex;
+        std::unordered_map<int, Clock::time_point> users; // userId -> 最近活跃时间
+    };
+
+    static const size_t kShardCount = 64; // 必须是2的幂
+
+    Shard& shardFor(int userId)
+    {
+        return shards_[shardIndex<kShardCount>(userId)];
+    }
+
+    void updatePeak(int online);
+
+private:
+    Shard            shards_[kShardCount];
+    std::atomic<int> current_;
+    std::atomic<int> peak_;
+};
@@ -0,0 +1,31 @@
+// 按userId选择分片：乘法散列后取高位，连续分配的userId也能均匀分布到各个分片
+// 分片数必须是2的幂，取的高位数由分片数决定
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shard_detail
+{
+    constexpr unsigned log2(size_t n)
+    {
+        return n <= 1 ? 0 : 1 + log2(n >> 1);
+    }
+} // namespace shard_detail
+
+template <size_t ShardCount>
+inline size_t shardIndex(int userId)
+{
+    static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0, "shard count must be a power of two");
+    static_assert(ShardCount <= (size_t(1) << 31), "shard count must fit in the 32-bit hash");
+    constexpr unsigned kBits = shard_detail::log2(ShardCount);
+    if constexpr (kBits == 0)
+    {
+        return 0;
+    }
+    else
+    {
+        uint32_t h = static_cast<uint32_t>(userId) * 2654435761u;
+        return h >> (32 - kBits);
+    }
+}
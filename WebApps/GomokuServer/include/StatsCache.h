@@ -0,0 +1,50 @@
+// 后台统计数据缓存
+// 注册用户总数在注册成功时增量更新，并由后台线程定期从数据库重新校准
+// /backend_data 的响应体由定时器预先生成，请求到来时直接返回，不访问数据库
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../../../HttpServer/include/http/ServerLimits.h"
+#include "../../../HttpServer/include/utils/MysqlUtil.h"
+
+class StatsCache
+{
+public:
+    StatsCache();
+    ~StatsCache();
+
+    // 启动后台校准线程，启动时立即校准一次，之后每隔resyncSeconds秒校准一次
+    void start(int resyncSeconds);
+
+    // 新用户注册成功
+    void addUser() { userCount_.fetch_add(1, std::memory_order_relaxed); }
+    int userCount() const { return userCount_.load(std::memory_order_relaxed); }
+
+    // 用最新的在线人数和服务器连接计数重新生成响应体
+    void refresh(int curOnline, int maxOnline, const http::ServerStats& server);
+    // 最近一次生成的响应体，还没生成过时返回nullptr
+    std::shared_ptr<const std::string> snapshot() const
+    {
+        return std::atomic_load(&body_);
+    }
+
+private:
+    void resyncLoop(int resyncSeconds);
+    // 从数据库查询用户总数，失败返回-1
+    int queryUserCount();
+
+private:
+    std::atomic<int>                   userCount_;
+    std::shared_ptr<const std::string> body_;     // 通过atomic_load/atomic_store读写
+    http::MysqlUtil                    mysqlUtil_;
+    std::thread                        resyncThread_;
+    std::mutex                         mutex_;
+    std::condition_variable            cv_;
+    bool                               stop_;
+};
@@ -0,0 +1,94 @@
+// 用户缓存：username -> (userId, 密码摘要)，挡在users表前面
+// 直接映射的定长表，每个槽用序列锁(seqlock)保护：读不加锁、不写共享内存，写者之间冲突时直接放弃本次写入（失效除外）
+// 不存在的用户也会缓存一小段时间（负缓存），避免用不存在的账号反复登录打到数据库
+// 每个槽有一个失效代数，查库前取得、写负缓存时核对，查询期间用户被注册（槽被失效）时丢弃这次的查询结果
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class UserCache
+{
+public:
+    using Digest = std::array<uint8_t, 32>; // SHA-256
+
+    enum class Lookup
+    {
+        kMiss,     // 缓存中没有，需要查数据库
+        kFound,    // 用户存在，userId和digest有效
+        kNotFound  // 用户不存在（负缓存）
+    };
+
+    static const int kPositiveTtlSeconds = 300;
+    static const int kNegativeTtlSeconds = 30;
+
+    // 单例模式
+    static UserCache& getInstance()
+    {
+        static UserCache instance;
+        return instance;
+    }
+
+    static Digest digest(const std::string& password);
+    // 常量时间比较，避免通过耗时推测摘要
+    static bool digestEqual(const Digest& a, const Digest& b);
+
+    Lookup lookup(const std::string& username, int& userId, Digest& digest);
+    void put(const std::string& username, int userId, const Digest& digest);
+    // 查询数据库之前取得，查不到用户时传给putMissing
+    uint64_t epoch(const std::string& username);
+    // 取得epoch之后槽被失效过时不写入
+    void putMissing(const std::string& username, uint64_t epoch);
+    // 一定会清空槽，遇到其他写者时等待它写完
+    void invalidate(const std::string& username);
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    UserCache() = default;
+
+    // 禁止拷贝构造
+    UserCache(const UserCache&) = delete;
+    UserCache& operator=(const UserCache&) = delete;
+
+    static const int    kSlotBits = 12;
+    static const size_t kSlotCount = 1u << kSlotBits;
+    static const size_t kMaxUsername = 32; // 更长的用户名不缓存
+
+    enum State : uint64_t
+    {
+        kEmpty = 0,
+        kPositive = 1,
+        kNegative = 2
+    };
+
+    // 槽中的数据全部按uint64_t原子读写，seq为奇数表示正在写
+    // words: [0, 4) 用户名  [4, 8) 摘要  [8] userId | 用户名长度 << 32 | 状态 << 40  [9] 过期时间(毫秒)
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> epoch{0}; // 失效代数，invalidate时加一
+        std::atomic<uint64_t> words[10];
+
+        Slot()
+        {
+            for (auto& w : words)
+                w.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    Slot& slotFor(const std::string& username);
+    // 取得槽的写权限（seq变为奇数），其他线程正在写时返回false
+    static bool tryLock(Slot& slot, uint64_t& seq);
+    // 写入槽并释放写权限，seq是tryLock取得的值
+    static void store(Slot& slot, uint64_t seq, const std::string& username, State state, int userId,
+                      const Digest& digest, int ttlSeconds);
+
+private:
+    Slot                  slots_[kSlotCount];
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
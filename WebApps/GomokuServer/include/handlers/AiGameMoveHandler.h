@@ -1,12 +1,17 @@
 #pragma once
 #include "../../../../HttpServer/include/router/RouterHandler.h"
 #include "../GomokuServer.h"
+#include "../MoveCodec.h"
 
 class AiGameMoveHandler : public http::router::RouterHandler
 {
 public:
     explicit AiGameMoveHandler(GomokuServer* server) : server_(server) {}
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
+private:
+    // 按协商好的格式填写落子结果
+    void respondMove(const std::string& version, MoveCodec::Format format, const AiGame& game,
+                     const MoveCodec::Outcome& outcome, http::HttpResponse* resp);
 private:
     GomokuServer* server_;
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "../../../../HttpServer/include/router/RouterHandler.h"
 #include "../../../HttpServer/include/utils/MysqlUtil.h"
 #include "../GomokuServer.h"
+#include "../UserCache.h"
+#include "../CredentialService.h"
 #include "../../../HttpServer/include/utils/JsonUtil.h"
 
 
@@ -13,7 +15,29 @@ public:
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
 
 private:
-    int queryUserId(const std::string& username, const std::string& password);
+    // 哈希线程池已满，返回503
+    static const int kServerBusy = -2;
+
+    // 数据库中取回的凭据，resolved为true表示已经由缓存或者查询结果得出userId，不需要再校验密码
+    struct StoredCredential
+    {
+        bool        resolved = false;
+        int         userId = -1;
+        std::string stored;
+    };
+    using Reply = std::function<void(int userId, const std::string& error)>;
+
+    // 在数据库线程中执行
+    StoredCredential loadCredential(const std::string& username, const std::string& password);
+    // 在哈希线程池中校验密码，完成后调用reply
+    void verifyCredential(const StoredCredential& cred, const std::string& username,
+                          const std::string& password, const Reply& reply);
+    void upgradePassword(int userId, const std::string& password);
+    // 以下在连接所在的IO线程中填写异步响应
+    void respondLogin(const std::string& version, std::shared_ptr<http::session::Session> session,
+                      const std::string& username, int userId, http::HttpResponse* resp);
+    void respondError(const std::string& version, const std::string& message, http::HttpResponse* resp);
+    void respondBusy(const std::string& version, http::HttpResponse* resp);
 
 private:
     GomokuServer*       server_;
@@ -2,6 +2,8 @@
 #include "../../../../HttpServer/include/router/RouterHandler.h"
 #include "../../../HttpServer/include/utils/MysqlUtil.h"
 #include "../GomokuServer.h"
+#include "../UserCache.h"
+#include "../CredentialService.h"
 
 class RegisterHandler : public http::router::RouterHandler 
 {
@@ -10,8 +12,11 @@ public:
 
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
 private:
-    int insertUser(const std::string& username, const std::string& password);
-    bool isUserExist(const std::string& username);
+    // passwordHash为CredentialService计算出的scrypt哈希
+    int insertUser(const std::string& username, const std::string& passwordHash);
+    // 在连接所在的IO线程中填写异步响应
+    void respondRegister(const std::string& version, int userId, const std::string& error, http::HttpResponse* resp);
+    void respondBusy(const std::string& version, http::HttpResponse* resp);
 private:
     GomokuServer* server_;
     http::MysqlUtil     mysqlUtil_;
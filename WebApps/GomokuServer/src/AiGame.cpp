@@ -1,4 +1,5 @@
 #include "AiGame.h"
+#include "OpeningBook.h"
 
 #include <chrono>
 #include <thread>
@@ -21,6 +22,7 @@ bool AiGame::humanMove(int x, int y)
         return false;
     
     board_[x][y] = HUMAN_PLAYER;
+    packed_.place(x, y, PackedBoard::kHuman);
     moveCount_++;
     lastMove_ = {x, y};
     
@@ -37,11 +39,16 @@ void AiGame::aiMove()
 {
     if (gameOver_ || isDraw()) return;
     
-    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 添加500毫秒延时
     int x, y;
-    // 获取AI的最佳移动位置
-    std::tie(x, y) = getBestMove();
+    // 开局阶段先查开局库，命中则直接落子，不做搜索
+    if (!OpeningBook::getInstance().lookup(board_, x, y))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 添加500毫秒延时
+        // 获取AI的最佳移动位置
+        std::tie(x, y) = getBestMove();
+    }
     board_[x][y] = AI_PLAYER;
+    packed_.place(x, y, PackedBoard::kAi);
     moveCount_++;
     lastMove_ = {x, y};
     
@@ -53,29 +60,6 @@ void AiGame::aiMove()
 }
 
 
-// 辅助函数：评估某个位置的威胁程度
-int AiGame::evaluateThreat(int r, int c) 
-{
-    int threat = 0;
-
-    // 检查四个方向上的玩家连子数
-    const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
-    for (auto& dir : directions) 
-    {
-        int count = 1;
-        for (int i = 1; i <= 2; i++) 
-        { // 探查2步
-            int nr = r + i * dir[0], nc = c + i * dir[1];
-            if (nr >= 0 && nr < BOARD_SIZE && nc >= 0 && nc < BOARD_SIZE && board_[nr][nc] == HUMAN_PLAYER) 
-            {
-                count++;
-            }
-        }
-        threat += count; // 威胁分数累加
-    }
-    return threat;
-}
-
 // 辅助函数：判断某个空位是否靠近已有棋子
 bool AiGame::isNearOccupied(int r, int c) 
 {
@@ -93,87 +77,36 @@ bool AiGame::isNearOccupied(int r, int c)
     return false;
 }
 
-// 检查胜利条件
+// 检查胜利条件：只扫描经过(x, y)的四条线
 bool AiGame::checkWin(int x, int y, const std::string& player) 
 {
-    // 检查方向数组：水平、垂直、对角线、反对角线
-    const int dx[] = {1, 0, 1, 1};
-    const int dy[] = {0, 1, 1, -1};
-    
-    for (int dir = 0; dir < 4; dir++) 
-    {
-        int count = 1;  // 当前位置已经有一个棋子
-        
-        // 正向检查
-        for (int i = 1; i < 5; i++) 
-        {
-            int newX = x + dx[dir] * i;
-            int newY = y + dy[dir] * i;
-            if (!isInBoard(newX, newY) || board_[newX][newY] != player) break;
-            count++;
-        }
-        
-        // 反向检查
-        for (int i = 1; i < 5; i++) 
-        {
-            int newX = x - dx[dir] * i;
-            int newY = y - dy[dir] * i;
-            if (!isInBoard(newX, newY) || board_[newX][newY] != player) break;
-            count++;
-        }
-        
-        if (count >= 5) return true;
-    }
-    return false;
+    int p = (player == AI_PLAYER) ? PackedBoard::kAi : PackedBoard::kHuman;
+    return LineScanner::checkWin(packed_, x, y, p);
 }
 
 
 std::pair<int, int> AiGame::getBestMove()
 {
     std::pair<int, int> bestMove = {-1, -1}; // 最佳落子位置
-    int maxThreat = -1;                      // 记录最大的威胁分数
 
-    // 1. 优先尝试进攻获胜或阻止玩家获胜
+    // 1. 优先尝试进攻获胜或阻止玩家获胜，取行优先的第一个成五点
+    uint16_t aiWins[BOARD_SIZE], humanWins[BOARD_SIZE];
+    LineScanner::winningMoves(packed_, PackedBoard::kAi, aiWins);
+    LineScanner::winningMoves(packed_, PackedBoard::kHuman, humanWins);
     for (int r = 0; r < BOARD_SIZE; r++) 
     {
-        for (int c = 0; c < BOARD_SIZE; c++) 
+        uint16_t wins = aiWins[r] | humanWins[r];
+        if (wins) 
         {
-            if (board_[r][c] != EMPTY) continue; // 确保当前位置为空闲
-
-            // 模拟 AI 落子，判断是否可以获胜
-            board_[r][c] = AI_PLAYER;
-            if (checkWin(r, c, AI_PLAYER)) 
-            {
-                // board_[r][c] = AI_PLAYER; // 恢复棋盘
-                return {r, c};      // 立即获胜
-            }
-            board_[r][c] = EMPTY;
-
-            // 模拟玩家落子，判断是否需要防守
-            board_[r][c] = HUMAN_PLAYER;
-            if (checkWin(r, c, HUMAN_PLAYER)) 
-            {
-                board_[r][c] = AI_PLAYER; // 恢复棋盘
-                return {r, c};      // 立即防守
-            }
-            board_[r][c] = EMPTY;
+            return {r, __builtin_ctz(wins)};
         }
     }
 
     // 2. 评估每个空位的威胁程度，选择最佳防守位置
-    for (int r = 0; r < BOARD_SIZE; r++) 
+    int cell = LineScanner::bestThreatMove(packed_);
+    if (cell >= 0) 
     {
-        for (int c = 0; c < BOARD_SIZE; c++) 
-        {
-            if (board_[r][c] != EMPTY) continue; // 确保当前位置为空闲
-
-            int threatLevel = evaluateThreat(r, c); // 评估威胁程度
-            if (threatLevel > maxThreat) 
-            {
-                maxThreat = threatLevel;
-                bestMove = {r, c};
-            }
-        }
+        bestMove = {cell / BOARD_SIZE, cell % BOARD_SIZE};
     }
 
     // 3. 如果找不到威胁点，选择靠近玩家或已有棋子的空位
@@ -196,7 +129,6 @@ std::pair<int, int> AiGame::getBestMove()
         if (!nearCells.empty()) 
 		{
             int num = rand();
-			board_[nearCells[num % nearCells.size()].first][nearCells[num % nearCells.size()].second] = AI_PLAYER;
             return nearCells[num % nearCells.size()];
         }
 
@@ -207,13 +139,11 @@ std::pair<int, int> AiGame::getBestMove()
             {
                 if (board_[r][c] == EMPTY) 
 				{
-					board_[r][c] = AI_PLAYER;
                     return {r, c}; // 返回第一个空位
                 }
             }
         }
     }
-	
-	board_[bestMove.first][bestMove.second] = AI_PLAYER;
+
     return bestMove; // 返回最佳防守点或其他策略的结果
 }
\ No newline at end of file
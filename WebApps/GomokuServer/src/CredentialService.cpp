@@ -0,0 +1,272 @@
+#include "../include/CredentialService.h"
+#include "../include/UserCache.h"
+
+#include <cstdio>
+
+#include <muduo/base/Logging.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+namespace
+{
+    const char   kPrefix[] = "$scrypt$";
+    const size_t kSaltLen = 16;
+    const size_t kKeyLen = 32;
+    // 存储的哈希最多允许使用当前配置4倍的内存（成本参数上下调整两档以内），超出的记录不计算
+    const uint64_t kMemoryHeadroom = 4;
+
+    std::string toHex(const unsigned char* data, size_t len)
+    {
+        static const char kDigits[] = "0123456789abcdef";
+        std::string out(len * 2, '0');
+        for (size_t i = 0; i < len; i++)
+        {
+            out[2 * i] = kDigits[data[i] >> 4];
+            out[2 * i + 1] = kDigits[data[i] & 0x0F];
+        }
+        return out;
+    }
+
+    int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    bool fromHex(const std::string& hex, std::string& out)
+    {
+        if (hex.size() % 2 != 0)
+            return false;
+        out.resize(hex.size() / 2);
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            int hi = hexValue(hex[2 * i]);
+            int lo = hexValue(hex[2 * i + 1]);
+            if (hi < 0 || lo < 0)
+                return false;
+            out[i] = static_cast<char>(hi << 4 | lo);
+        }
+        return true;
+    }
+} // namespace
+
+CredentialService::~CredentialService()
+{
+    stop();
+}
+
+void CredentialService::start(const CredentialConfig& config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+        return;
+    config_ = config;
+    running_ = true;
+    for (int i = 0; i < config_.threads; i++)
+    {
+        workers_.emplace_back(&CredentialService::workerLoop, this);
+    }
+    LOG_INFO << "CredentialService started: threads=" << config_.threads
+             << " N=2^" << config_.costLog2 << " r=" << config_.blockSize << " p=" << config_.parallelism;
+}
+
+void CredentialService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+            return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_)
+    {
+        if (t.joinable())
+            t.join();
+    }
+    workers_.clear();
+
+    // 没有开始的任务不再计算，但回调必须执行，否则等待它的异步应答永远不会发出
+    std::deque<Task> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending.swap(queue_);
+    }
+    if (!pending.empty())
+        LOG_WARN << "CredentialService stopped with " << pending.size() << " pending tasks";
+    for (auto& task : pending)
+    {
+        try
+        {
+            task.cancel();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR << "Credential task cancel failed: " << e.what();
+        }
+    }
+}
+
+bool CredentialService::hashAsync(const std::string& password, HashCallback cb)
+{
+    return submit({[this, password, cb]() { cb(hash(password)); },
+                   [cb]() { cb(""); }});
+}
+
+bool CredentialService::verifyAsync(const std::string& password, const std::string& stored, VerifyCallback cb)
+{
+    return submit({[this, password, stored, cb]() { cb(verify(password, stored)); },
+                   [cb]() { cb(false); }});
+}
+
+std::string CredentialService::hash(const std::string& password) const
+{
+    Params params = {config_.costLog2, config_.blockSize, config_.parallelism};
+    unsigned char salt[kSaltLen];
+    unsigned char key[kKeyLen];
+    if (RAND_bytes(salt, sizeof(salt)) != 1 ||
+        !derive(password, std::string(reinterpret_cast<char*>(salt), sizeof(salt)), params, key, sizeof(key)))
+    {
+        LOG_ERROR << "scrypt hash failed";
+        return "";
+    }
+
+    char head[64];
+    std::snprintf(head, sizeof(head), "%sln=%u,r=%u,p=%u$", kPrefix,
+                  params.costLog2, params.blockSize, params.parallelism);
+    return head + toHex(salt, sizeof(salt)) + "$" + toHex(key, sizeof(key));
+}
+
+bool CredentialService::verify(const std::string& password, const std::string& stored) const
+{
+    Params params;
+    std::string salt, expected;
+    if (!parse(stored, params, salt, expected))
+    {
+        // 带scrypt前缀却解析不了的是损坏的记录，不能当成明文，否则输入记录原文就能登录
+        if (stored.compare(0, sizeof(kPrefix) - 1, kPrefix) == 0)
+        {
+            LOG_ERROR << "Malformed scrypt hash in credential store";
+            return false;
+        }
+        // 旧的明文记录，比较摘要而不是直接比较字符串，避免泄露长度和前缀信息
+        return UserCache::digestEqual(UserCache::digest(password), UserCache::digest(stored));
+    }
+    // 参数来自数据库，按本服务的配置限制单次计算的内存，防止异常记录让哈希线程申请上GB内存
+    Params configured = {config_.costLog2, config_.blockSize, config_.parallelism};
+    if (memoryCost(params) > kMemoryHeadroom * memoryCost(configured))
+    {
+        LOG_ERROR << "Stored scrypt parameters exceed memory budget: ln=" << params.costLog2
+                  << " r=" << params.blockSize << " p=" << params.parallelism;
+        return false;
+    }
+
+    unsigned char key[kKeyLen];
+    if (expected.size() != sizeof(key) || !derive(password, salt, params, key, sizeof(key)))
+        return false;
+    return CRYPTO_memcmp(key, expected.data(), sizeof(key)) == 0;
+}
+
+bool CredentialService::needsRehash(const std::string& stored) const
+{
+    Params params;
+    std::string salt, key;
+    if (!parse(stored, params, salt, key))
+        return true;
+    return params.costLog2 < config_.costLog2 ||
+           params.blockSize < config_.blockSize ||
+           params.parallelism < config_.parallelism;
+}
+
+size_t CredentialService::queueSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+bool CredentialService::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || queue_.size() >= config_.maxQueueSize)
+        {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void CredentialService::workerLoop()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+            // 停止时未开始的任务留在队列中，由stop()以失败结果回调
+            if (!running_)
+                return;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        try
+        {
+            task.run();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR << "Credential task failed: " << e.what();
+        }
+    }
+}
+
+bool CredentialService::parse(const std::string& stored, Params& params, std::string& salt, std::string& key)
+{
+    if (stored.compare(0, sizeof(kPrefix) - 1, kPrefix) != 0)
+        return false;
+
+    unsigned ln, r, p;
+    int consumed = 0;
+    if (std::sscanf(stored.c_str() + sizeof(kPrefix) - 1, "ln=%u,r=%u,p=%u$%n", &ln, &r, &p, &consumed) != 3 ||
+        consumed == 0)
+        return false;
+    // 参数来自数据库，限制在合理范围内，防止异常记录耗尽内存
+    if (ln < 1 || ln > 20 || r < 1 || r > 32 || p < 1 || p > 16)
+        return false;
+
+    size_t saltPos = sizeof(kPrefix) - 1 + consumed;
+    size_t sep = stored.find('$', saltPos);
+    if (sep == std::string::npos ||
+        !fromHex(stored.substr(saltPos, sep - saltPos), salt) ||
+        !fromHex(stored.substr(sep + 1), key))
+        return false;
+
+    params = {ln, r, p};
+    return true;
+}
+
+bool CredentialService::derive(const std::string& password, const std::string& salt, const Params& params,
+                               unsigned char* out, size_t outLen)
+{
+    uint64_t n = 1ULL << params.costLog2;
+    // 留一些余量
+    uint64_t maxMem = memoryCost(params) + (1ULL << 20);
+    return EVP_PBE_scrypt(password.data(), password.size(),
+                          reinterpret_cast<const unsigned char*>(salt.data()), salt.size(),
+                          n, params.blockSize, params.parallelism, maxMem, out, outLen) == 1;
+}
+
+uint64_t CredentialService::memoryCost(const Params& params)
+{
+    // scrypt需要约 128 * r * (N + p) 字节内存
+    return 128ULL * params.blockSize * ((1ULL << params.costLog2) + params.parallelism);
+}
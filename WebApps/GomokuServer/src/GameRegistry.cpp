@@ -0,0 +1,104 @@
+#include "../include/GameRegistry.h"
+
+GameRegistry::GamePtr GameRegistry::getOrCreate(int userId)
+{
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Entry& entry = shard.games[userId];
+    if (!entry.game)
+        entry.game = std::make_shared<AiGame>(userId);
+    entry.lastActive = Clock::now();
+    return entry.game;
+}
+
+GameRegistry::GamePtr GameRegistry::find(int userId)
+{
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.games.find(userId);
+    if (it == shard.games.end())
+        return nullptr;
+    it->second.lastActive = Clock::now();
+    return it->second.game;
+}
+
+GameRegistry::GamePtr GameRegistry::reset(int userId)
+{
+    // 先在锁外创建对局，缩短持锁时间
+    GamePtr game = std::make_shared<AiGame>(userId);
+    GamePtr old;
+    {
+        Shard& shard = shardFor(userId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry& entry = shard.games[userId];
+        old.swap(entry.game); // 旧对局在锁外析构
+        entry.game = game;
+        entry.lastActive = Clock::now();
+    }
+    return game;
+}
+
+void GameRegistry::erase(int userId)
+{
+    GamePtr old;
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.games.find(userId);
+    if (it != shard.games.end())
+    {
+        old.swap(it->second.game);
+        shard.games.erase(it);
+    }
+}
+
+void GameRegistry::erase(int userId, const GamePtr& game)
+{
+    GamePtr old;
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.games.find(userId);
+    if (it != shard.games.end() && it->second.game == game)
+    {
+        old.swap(it->second.game);
+        shard.games.erase(it);
+    }
+}
+
+size_t GameRegistry::evictIdle(int idleSeconds)
+{
+    Clock::time_point deadline = Clock::now() - std::chrono::seconds(idleSeconds);
+    size_t evicted = 0;
+    for (auto& shard : shards_)
+    {
+        // 逐个分片加锁，不会长时间阻塞所有请求
+        std::vector<GamePtr> expired;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.games.begin(); it != shard.games.end();)
+            {
+                if (it->second.lastActive < deadline)
+                {
+                    expired.push_back(std::move(it->second.game));
+                    it = shard.games.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        evicted += expired.size();
+    }
+    return evicted;
+}
+
+size_t GameRegistry::size() const
+{
+    size_t total = 0;
+    for (const auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.games.size();
+    }
+    return total;
+}
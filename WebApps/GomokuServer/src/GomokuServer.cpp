@@ -7,6 +7,7 @@
 #include "../include/handlers/AiGameMoveHandler.h"
 #include "../include/handlers/GameBackendHandler.h"
 #include "../include/GomokuServer.h"
+#include "../include/OpeningBook.h"
 #include "../../../HttpServer/include/http/HttpRequest.h"
 #include "../../../HttpServer/include/http/HttpResponse.h"
 #include "../../../HttpServer/include/http/HttpServer.h"
@@ -16,7 +17,7 @@ using namespace http;
 GomokuServer::GomokuServer(int port,
                            const std::string &name,
                            muduo::net::TcpServer::Option option)
-    : httpServer_(port, name, option), maxOnline_(0)
+    : httpServer_(port, name, false, option)
 {
     initialize();
 }
@@ -26,21 +27,53 @@ void GomokuServer::setThreadNum(int numThreads)
     httpServer_.setThreadNum(numThreads);
 }
 
+void GomokuServer::setReusePortListeners(bool on)
+{
+    httpServer_.setReusePortListeners(on);
+}
+
+void GomokuServer::setCpuAffinity(bool on)
+{
+    httpServer_.setCpuAffinity(on);
+}
+
+void GomokuServer::setHandoffPath(const std::string &path)
+{
+    httpServer_.setHandoffPath(path);
+}
+
 void GomokuServer::start()
 {
     httpServer_.start();
+    // 服务器已退出，结束仍持有异步应答sender的工作线程，它们不能晚于httpServer_析构
+    CredentialService::getInstance().stop();
+    http::db::DbExecutor::getInstance().stop();
 }
 
 void GomokuServer::initialize()
 {
-    // 初始化数据库连接池
-    http::MysqlUtil::init("tcp://127.0.0.1:3306", "root", "root", "Gomoku", 10);
+    // 初始化数据库连接池：常驻4个连接，高峰时最多扩到16个，获取连接最多等3秒
+    http::db::DbPoolConfig poolConfig;
+    poolConfig.minSize = 4;
+    poolConfig.maxSize = 16;
+    poolConfig.acquireTimeoutMs = 3000;
+    http::MysqlUtil::init("tcp://127.0.0.1:3306", "root", "root", "Gomoku", poolConfig);
+    // 启动密码哈希线程池：2个线程，N = 2^14，单次哈希约16MB内存、几十毫秒
+    CredentialConfig credentialConfig;
+    credentialConfig.threads = 2;
+    credentialConfig.maxQueueSize = 256;
+    credentialConfig.costLog2 = 14;
+    CredentialService::getInstance().start(credentialConfig);
     // 初始化会话
     initializeSession();
     // 初始化中间件
     initializeMiddleware();
     // 初始化路由
     initializeRouter();
+    // 加载开局库
+    initializeOpeningBook();
+    // 初始化定时任务
+    initializeTimers();
 }
 
 void GomokuServer::initializeSession()
@@ -55,10 +88,22 @@ void GomokuServer::initializeSession()
 
 void GomokuServer::initializeMiddleware()
 {
-    // 创建中间件
-    auto corsMiddleware = std::make_shared<http::middleware::CorsMiddleware>();
-    // 添加中间件
-    httpServer_.addMiddleware(corsMiddleware);
+    // 中间件在编译期组合成一条流水线，整体作为一个中间件加入，以后新增的中间件类型加在模板参数里
+    using Pipeline = http::middleware::StaticMiddlewareChain<http::middleware::CorsMiddleware,
+                                                             http::middleware::RateLimitMiddleware>;
+
+    // 限流：落子按会话限流，登录注册按IP限流防止暴力尝试，其余接口使用宽松的默认值
+    http::middleware::RateLimitConfig rateConfig = http::middleware::RateLimitConfig::defaultConfig();
+    rateConfig.rules.push_back({"/aiBot/move", 5, 10, http::middleware::RateLimitRule::kSession});
+    rateConfig.rules.push_back({"/login", 1, 5, http::middleware::RateLimitRule::kPeerIp});
+    rateConfig.rules.push_back({"/register", 1, 5, http::middleware::RateLimitRule::kPeerIp});
+    // 只有服务端已经建立的会话才单独限流，随意伪造的cookie按IP限流
+    rateConfig.sessionValidator = [this](const std::string& sessionId) {
+        return httpServer_.getSessionManager()->hasSession(sessionId);
+    };
+
+    // 添加中间件，CORS在外层，被限流的429响应也带上CORS头
+    httpServer_.addMiddleware(std::make_shared<Pipeline>(http::middleware::CorsConfig::defaultConfig(), rateConfig));
 }
 
 void GomokuServer::initializeRouter()
@@ -93,6 +138,45 @@ void GomokuServer::initializeRouter()
     });
 }
 
+void GomokuServer::initializeOpeningBook()
+{
+    std::string bookFile("../WebApps/GomokuServer/resource/opening.book");
+    OpeningBook& book = OpeningBook::getInstance();
+    if (book.load(bookFile))
+        return;
+
+    // 开局库文件不存在或已损坏，由内置开局表重新生成，写回文件后再mmap加载
+    book.buildDefault();
+    if (book.save(bookFile))
+    {
+        book.load(bookFile);
+    }
+}
+
+void GomokuServer::initializeTimers()
+{
+    // 后台统计：用户总数每5分钟从数据库校准一次，响应体每秒重新生成一次
+    statsCache_.start(300);
+    statsCache_.refresh(getCurOnline(), getMaxOnline(), httpServer_.stats());
+    httpServer_.getLoop()->runEvery(1.0, [this]() {
+        statsCache_.refresh(getCurOnline(), getMaxOnline(), httpServer_.stats());
+    });
+
+    // 定期回收长时间无人操作的对局和在线状态（用户直接关闭页面时不会走登出流程）
+    httpServer_.getLoop()->runEvery(60.0, [this]() {
+        size_t evicted = aiGames_.evictIdle(AI_GAME_IDLE_TIMEOUT);
+        if (evicted > 0)
+        {
+            LOG_INFO << "Evicted " << evicted << " idle ai games, " << aiGames_.size() << " left";
+        }
+        size_t expired = onlineUsers_.expireIdle(USER_IDLE_TIMEOUT);
+        if (expired > 0)
+        {
+            LOG_INFO << "Expired " << expired << " idle users, " << onlineUsers_.current() << " online";
+        }
+    });
+}
+
 void GomokuServer::restartChessGameVsAi(const http::HttpRequest &req, http::HttpResponse *resp)
 {
     // 解析请求体
@@ -100,11 +184,7 @@ void GomokuServer::restartChessGameVsAi(const http::HttpRequest &req, http::Http
     if (session->getValue("isLoggedIn") != "true")
     {
         // 用户未登录，返回未授权错误
-        json errorResp;
-        errorResp["status"] = "error";
-        errorResp["message"] = "Unauthorized";
-        std::string errorBody = errorResp.dump(4);
-
+        const std::string &errorBody = ErrorBodies::unauthorized();
         packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                     "Unauthorized", true, "application/json", errorBody.size(),
                     errorBody, resp);
@@ -112,19 +192,16 @@ void GomokuServer::restartChessGameVsAi(const http::HttpRequest &req, http::Http
     }
 
     int userId = std::stoi(session->getValue("userId"));
-    {
-        // 重新开始ai对战
-        std::lock_guard<std::mutex> lock(mutexForAiGames_);
-        if (aiGames_.find(userId) != aiGames_.end())
-            aiGames_.erase(userId);
-        aiGames_[userId] = std::make_shared<AiGame>(userId);
-    }
+    // 重新开始ai对战
+    onlineUsers_.touch(userId);
+    aiGames_.reset(userId);
 
-    json successResp;
-    successResp["status"] = "ok";
-    successResp["message"] = "restart successful";
-    successResp["userId"] = userId;
-    std::string successBody = successResp.dump(4);
+    std::string successBody;
+    JsonWriter(&successBody).beginObject()
+                            .field("status", "ok")
+                            .field("message", "restart successful")
+                            .field("userId", userId)
+                            .endObject();
     packageResp(req.getVersion(), http::HttpResponse::k200Ok, "OK", false, "application/json", successBody.size(), successBody, resp);
 }
 
@@ -133,35 +210,20 @@ void GomokuServer::getBackendData(const http::HttpRequest &req, http::HttpRespon
 {
     try 
     {
-        // 获取数据
-        int curOnline = getCurOnline();
-        LOG_INFO << "当前在线人数: " << curOnline;
-        
-        int maxOnline = getMaxOnline();
-        LOG_INFO << "历史最高在线人数: " << maxOnline;
-        
-        int totalUser = getUserCount();
-        LOG_INFO << "已注册用户总数: " << totalUser;
-
-        // 构造 JSON 响应
-        nlohmann::json respBody;
-        respBody = {
-            {"curOnline", curOnline},
-            {"maxOnline", maxOnline},
-            {"totalUser", totalUser}
-        };
+        // 直接使用定时生成的响应体，不访问数据库
+        auto body = statsCache_.snapshot();
+        if (!body)
+        {
+            statsCache_.refresh(getCurOnline(), getMaxOnline(), httpServer_.stats());
+            body = statsCache_.snapshot();
+        }
 
-        // 转换为字符串
-        std::string responseStr = respBody.dump(4);
-        
         // 设置响应
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setContentType("application/json");
-        resp->setBody(responseStr);
-        resp->setContentLength(responseStr.size());
+        resp->setBody(*body);
+        resp->setContentLength(body->size());
         resp->setCloseConnection(false);
-
-        LOG_INFO << "Backend data response prepared successfully";
     }
     catch (const std::exception& e) 
     {
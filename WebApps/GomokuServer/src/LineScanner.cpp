@@ -0,0 +1,424 @@
+#include "LineScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOMOKU_X86_SIMD 1
+#endif
+
+namespace
+{
+    const int kSize = PackedBoard::kSize;
+    const int kLanes = PackedBoard::kLanes;
+    const uint16_t kFullRow = (1u << kSize) - 1;
+
+    // 每条线上实际存在的格子，对角线越靠边越短
+    struct ValidMask
+    {
+        alignas(32) uint16_t lanes[kLanes];
+
+        ValidMask()
+        {
+            for (int i = 0; i < kLanes; i++)
+                lanes[i] = 0;
+            for (int i = 0; i < kSize; i++)
+            {
+                lanes[PackedBoard::kRowBase + i] = kFullRow;
+                lanes[PackedBoard::kColBase + i] = kFullRow;
+            }
+            for (int x = 0; x < kSize; x++)
+            {
+                for (int y = 0; y < kSize; y++)
+                {
+                    lanes[PackedBoard::kDiagBase + x - y + kSize - 1] |= static_cast<uint16_t>(1u << y);
+                    lanes[PackedBoard::kAntiDiagBase + x + y] |= static_cast<uint16_t>(1u << y);
+                }
+            }
+        }
+    };
+
+    const ValidMask& validMaskTable()
+    {
+        static ValidMask mask;
+        return mask;
+    }
+
+    // 取出最低位的1所在的格子
+    int firstCell(const uint16_t* rows)
+    {
+        for (int r = 0; r < kSize; r++)
+        {
+            if (rows[r])
+                return r * kSize + __builtin_ctz(rows[r]);
+        }
+        return -1;
+    }
+
+    // ---------------------------------------------------------------------
+    // 标量实现
+    // ---------------------------------------------------------------------
+    bool scalarHasFive(const uint16_t* own)
+    {
+        for (int i = 0; i < kLanes; i++)
+        {
+            uint16_t m = own[i];
+            if (m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4))
+                return true;
+        }
+        return false;
+    }
+
+    // 空位c能成五，当且仅当存在一个包含c的长度为5的窗口，窗口内其余4格都是己方棋子
+    // 用移位表示相对偏移：m >> k 的第c位是第c + k格，m << k 的第c位是第c - k格
+    void scalarWinningMoves(const uint16_t* own, const uint16_t* other, uint16_t* out)
+    {
+        const uint16_t* valid = validMaskTable().lanes;
+        for (int i = 0; i < kLanes; i++)
+        {
+            uint32_t m = own[i];
+            uint32_t empty = ~(own[i] | other[i]) & valid[i];
+            uint32_t r1 = m >> 1, r2 = m >> 2, r3 = m >> 3, r4 = m >> 4;
+            uint32_t l1 = m << 1, l2 = m << 2, l3 = m << 3, l4 = m << 4;
+            uint32_t win = (r1 & r2 & r3 & r4) | (l1 & r1 & r2 & r3) | (l2 & l1 & r1 & r2) |
+                           (l3 & l2 & l1 & r1) | (l4 & l3 & l2 & l1);
+            out[i] = static_cast<uint16_t>(win & empty);
+        }
+    }
+
+    // 威胁分 = 4 + 四个正方向上前两格的人类棋子数，8个一位输入用进位保留加法器按位并行求和
+    int scalarBestThreat(const uint16_t* humanRows, const uint16_t* emptyRows)
+    {
+        uint16_t sums[4][16];
+        for (int r = 0; r < 16; r++)
+        {
+            uint16_t h0 = humanRows[r], h1 = humanRows[r + 1], h2 = humanRows[r + 2];
+            uint16_t in[8] = {
+                static_cast<uint16_t>(h0 >> 1), static_cast<uint16_t>(h0 >> 2),               // (0, 1)
+                h1, h2,                                                                        // (1, 0)
+                static_cast<uint16_t>(h1 >> 1), static_cast<uint16_t>(h2 >> 2),               // (1, 1)
+                static_cast<uint16_t>((h1 << 1) & kFullRow), static_cast<uint16_t>((h2 << 2) & kFullRow)}; // (1, -1)
+
+            uint16_t sa = in[0] ^ in[1] ^ in[2], ca = (in[0] & in[1]) | (in[2] & (in[0] ^ in[1]));
+            uint16_t sb = in[3] ^ in[4] ^ in[5], cb = (in[3] & in[4]) | (in[5] & (in[3] ^ in[4]));
+            uint16_t sc = in[6] ^ in[7] ^ sa, cc = (in[6] & in[7]) | (sa & (in[6] ^ in[7]));
+            uint16_t s0 = sb ^ sc, cd = sb & sc;
+            uint16_t ts = ca ^ cb ^ cc, tc = (ca & cb) | (cc & (ca ^ cb));
+            uint16_t s1 = ts ^ cd, tc2 = ts & cd;
+            sums[0][r] = s0;
+            sums[1][r] = s1;
+            sums[2][r] = tc ^ tc2;
+            sums[3][r] = tc & tc2;
+        }
+
+        // 从最高位开始逐位筛选，留下的就是得分最高的空位
+        uint16_t cand[16];
+        for (int r = 0; r < 16; r++)
+            cand[r] = emptyRows[r];
+        for (int bit = 3; bit >= 0; bit--)
+        {
+            uint16_t next[16];
+            uint16_t any = 0;
+            for (int r = 0; r < 16; r++)
+            {
+                next[r] = cand[r] & sums[bit][r];
+                any |= next[r];
+            }
+            if (any)
+            {
+                for (int r = 0; r < 16; r++)
+                    cand[r] = next[r];
+            }
+        }
+        return firstCell(cand);
+    }
+
+    const LineScanner::Kernels kScalarKernels = {
+        "scalar", scalarHasFive, scalarWinningMoves, scalarBestThreat};
+
+#ifdef GOMOKU_X86_SIMD
+    // ---------------------------------------------------------------------
+    // SSE2实现，一个寄存器处理8条线
+    // ---------------------------------------------------------------------
+    __attribute__((target("sse2"))) bool sse2HasFive(const uint16_t* own)
+    {
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < kLanes; i += 8)
+        {
+            __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(own + i));
+            __m128i f = _mm_and_si128(_mm_and_si128(m, _mm_srli_epi16(m, 1)),
+                                      _mm_and_si128(_mm_srli_epi16(m, 2), _mm_srli_epi16(m, 3)));
+            acc = _mm_or_si128(acc, _mm_and_si128(f, _mm_srli_epi16(m, 4)));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi16(acc, _mm_setzero_si128())) != 0xFFFF;
+    }
+
+    __attribute__((target("sse2"))) void sse2WinningMoves(const uint16_t* own, const uint16_t* other, uint16_t* out)
+    {
+        const uint16_t* valid = validMaskTable().lanes;
+        for (int i = 0; i < kLanes; i += 8)
+        {
+            __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(own + i));
+            __m128i o = _mm_load_si128(reinterpret_cast<const __m128i*>(other + i));
+            __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(valid + i));
+            __m128i empty = _mm_andnot_si128(_mm_or_si128(m, o), v);
+
+            __m128i r1 = _mm_srli_epi16(m, 1), r2 = _mm_srli_epi16(m, 2);
+            __m128i r3 = _mm_srli_epi16(m, 3), r4 = _mm_srli_epi16(m, 4);
+            __m128i l1 = _mm_slli_epi16(m, 1), l2 = _mm_slli_epi16(m, 2);
+            __m128i l3 = _mm_slli_epi16(m, 3), l4 = _mm_slli_epi16(m, 4);
+            __m128i r12 = _mm_and_si128(r1, r2), l12 = _mm_and_si128(l1, l2);
+            __m128i win = _mm_and_si128(r12, _mm_and_si128(r3, r4));
+            win = _mm_or_si128(win, _mm_and_si128(_mm_and_si128(l1, r12), r3));
+            win = _mm_or_si128(win, _mm_and_si128(l12, r12));
+            win = _mm_or_si128(win, _mm_and_si128(_mm_and_si128(l12, r1), l3));
+            win = _mm_or_si128(win, _mm_and_si128(l12, _mm_and_si128(l3, l4)));
+            _mm_store_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(win, empty));
+        }
+    }
+
+    __attribute__((target("sse2"))) int sse2BestThreat(const uint16_t* humanRows, const uint16_t* emptyRows)
+    {
+        const __m128i full = _mm_set1_epi16(static_cast<short>(kFullRow));
+        __m128i sums[4][2];
+        __m128i cand[2];
+        for (int half = 0; half < 2; half++)
+        {
+            const uint16_t* base = humanRows + half * 8;
+            __m128i h0 = _mm_load_si128(reinterpret_cast<const __m128i*>(base));
+            __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 1));
+            __m128i h2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + 2));
+            __m128i in0 = _mm_srli_epi16(h0, 1), in1 = _mm_srli_epi16(h0, 2);
+            __m128i in2 = h1, in3 = h2;
+            __m128i in4 = _mm_srli_epi16(h1, 1), in5 = _mm_srli_epi16(h2, 2);
+            __m128i in6 = _mm_and_si128(_mm_slli_epi16(h1, 1), full);
+            __m128i in7 = _mm_and_si128(_mm_slli_epi16(h2, 2), full);
+
+            __m128i x01 = _mm_xor_si128(in0, in1);
+            __m128i sa = _mm_xor_si128(x01, in2);
+            __m128i ca = _mm_or_si128(_mm_and_si128(in0, in1), _mm_and_si128(in2, x01));
+            __m128i x34 = _mm_xor_si128(in3, in4);
+            __m128i sb = _mm_xor_si128(x34, in5);
+            __m128i cb = _mm_or_si128(_mm_and_si128(in3, in4), _mm_and_si128(in5, x34));
+            __m128i x67 = _mm_xor_si128(in6, in7);
+            __m128i sc = _mm_xor_si128(x67, sa);
+            __m128i cc = _mm_or_si128(_mm_and_si128(in6, in7), _mm_and_si128(sa, x67));
+            __m128i cd = _mm_and_si128(sb, sc);
+            __m128i xab = _mm_xor_si128(ca, cb);
+            __m128i ts = _mm_xor_si128(xab, cc);
+            __m128i tc = _mm_or_si128(_mm_and_si128(ca, cb), _mm_and_si128(cc, xab));
+            __m128i tc2 = _mm_and_si128(ts, cd);
+            sums[0][half] = _mm_xor_si128(sb, sc);
+            sums[1][half] = _mm_xor_si128(ts, cd);
+            sums[2][half] = _mm_xor_si128(tc, tc2);
+            sums[3][half] = _mm_and_si128(tc, tc2);
+            cand[half] = _mm_load_si128(reinterpret_cast<const __m128i*>(emptyRows + half * 8));
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        for (int bit = 3; bit >= 0; bit--)
+        {
+            __m128i n0 = _mm_and_si128(cand[0], sums[bit][0]);
+            __m128i n1 = _mm_and_si128(cand[1], sums[bit][1]);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_or_si128(n0, n1), zero)) != 0xFFFF)
+            {
+                cand[0] = n0;
+                cand[1] = n1;
+            }
+        }
+
+        alignas(16) uint16_t rows[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(rows), cand[0]);
+        _mm_store_si128(reinterpret_cast<__m128i*>(rows + 8), cand[1]);
+        return firstCell(rows);
+    }
+
+    // ---------------------------------------------------------------------
+    // AVX2实现，一个寄存器处理16条线，整个棋盘的行掩码正好放进一个寄存器
+    // ---------------------------------------------------------------------
+    __attribute__((target("avx2"))) bool avx2HasFive(const uint16_t* own)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for (int i = 0; i < kLanes; i += 16)
+        {
+            __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(own + i));
+            __m256i f = _mm256_and_si256(_mm256_and_si256(m, _mm256_srli_epi16(m, 1)),
+                                         _mm256_and_si256(_mm256_srli_epi16(m, 2), _mm256_srli_epi16(m, 3)));
+            acc = _mm256_or_si256(acc, _mm256_and_si256(f, _mm256_srli_epi16(m, 4)));
+        }
+        return !_mm256_testz_si256(acc, acc);
+    }
+
+    __attribute__((target("avx2"))) void avx2WinningMoves(const uint16_t* own, const uint16_t* other, uint16_t* out)
+    {
+        const uint16_t* valid = validMaskTable().lanes;
+        for (int i = 0; i < kLanes; i += 16)
+        {
+            __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(own + i));
+            __m256i o = _mm256_load_si256(reinterpret_cast<const __m256i*>(other + i));
+            __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(valid + i));
+            __m256i empty = _mm256_andnot_si256(_mm256_or_si256(m, o), v);
+
+            __m256i r1 = _mm256_srli_epi16(m, 1), r2 = _mm256_srli_epi16(m, 2);
+            __m256i r3 = _mm256_srli_epi16(m, 3), r4 = _mm256_srli_epi16(m, 4);
+            __m256i l1 = _mm256_slli_epi16(m, 1), l2 = _mm256_slli_epi16(m, 2);
+            __m256i l3 = _mm256_slli_epi16(m, 3), l4 = _mm256_slli_epi16(m, 4);
+            __m256i r12 = _mm256_and_si256(r1, r2), l12 = _mm256_and_si256(l1, l2);
+            __m256i win = _mm256_and_si256(r12, _mm256_and_si256(r3, r4));
+            win = _mm256_or_si256(win, _mm256_and_si256(_mm256_and_si256(l1, r12), r3));
+            win = _mm256_or_si256(win, _mm256_and_si256(l12, r12));
+            win = _mm256_or_si256(win, _mm256_and_si256(_mm256_and_si256(l12, r1), l3));
+            win = _mm256_or_si256(win, _mm256_and_si256(l12, _mm256_and_si256(l3, l4)));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(win, empty));
+        }
+    }
+
+    __attribute__((target("avx2"))) int avx2BestThreat(const uint16_t* humanRows, const uint16_t* emptyRows)
+    {
+        const __m256i full = _mm256_set1_epi16(static_cast<short>(kFullRow));
+        __m256i h0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(humanRows));
+        __m256i h1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(humanRows + 1));
+        __m256i h2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(humanRows + 2));
+        __m256i in0 = _mm256_srli_epi16(h0, 1), in1 = _mm256_srli_epi16(h0, 2);
+        __m256i in2 = h1, in3 = h2;
+        __m256i in4 = _mm256_srli_epi16(h1, 1), in5 = _mm256_srli_epi16(h2, 2);
+        __m256i in6 = _mm256_and_si256(_mm256_slli_epi16(h1, 1), full);
+        __m256i in7 = _mm256_and_si256(_mm256_slli_epi16(h2, 2), full);
+
+        __m256i x01 = _mm256_xor_si256(in0, in1);
+        __m256i sa = _mm256_xor_si256(x01, in2);
+        __m256i ca = _mm256_or_si256(_mm256_and_si256(in0, in1), _mm256_and_si256(in2, x01));
+        __m256i x34 = _mm256_xor_si256(in3, in4);
+        __m256i sb = _mm256_xor_si256(x34, in5);
+        __m256i cb = _mm256_or_si256(_mm256_and_si256(in3, in4), _mm256_and_si256(in5, x34));
+        __m256i x67 = _mm256_xor_si256(in6, in7);
+        __m256i sc = _mm256_xor_si256(x67, sa);
+        __m256i cc = _mm256_or_si256(_mm256_and_si256(in6, in7), _mm256_and_si256(sa, x67));
+        __m256i cd = _mm256_and_si256(sb, sc);
+        __m256i xab = _mm256_xor_si256(ca, cb);
+        __m256i ts = _mm256_xor_si256(xab, cc);
+        __m256i tc = _mm256_or_si256(_mm256_and_si256(ca, cb), _mm256_and_si256(cc, xab));
+        __m256i tc2 = _mm256_and_si256(ts, cd);
+        __m256i sums[4] = {
+            _mm256_xor_si256(sb, sc),
+            _mm256_xor_si256(ts, cd),
+            _mm256_xor_si256(tc, tc2),
+            _mm256_and_si256(tc, tc2)};
+
+        __m256i cand = _mm256_load_si256(reinterpret_cast<const __m256i*>(emptyRows));
+        for (int bit = 3; bit >= 0; bit--)
+        {
+            __m256i next = _mm256_and_si256(cand, sums[bit]);
+            if (!_mm256_testz_si256(next, next))
+                cand = next;
+        }
+
+        alignas(32) uint16_t rows[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(rows), cand);
+        return firstCell(rows);
+    }
+
+    const LineScanner::Kernels kSse2Kernels = {
+        "sse2", sse2HasFive, sse2WinningMoves, sse2BestThreat};
+    const LineScanner::Kernels kAvx2Kernels = {
+        "avx2", avx2HasFive, avx2WinningMoves, avx2BestThreat};
+#endif
+} // namespace
+
+const LineScanner::Kernels& LineScanner::scalar()
+{
+    return kScalarKernels;
+}
+
+const LineScanner::Kernels* LineScanner::sse2()
+{
+#ifdef GOMOKU_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("sse2");
+    return supported ? &kSse2Kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const LineScanner::Kernels* LineScanner::avx2()
+{
+#ifdef GOMOKU_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported ? &kAvx2Kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const LineScanner::Kernels& LineScanner::active()
+{
+    static const Kernels& kernels = avx2() ? *avx2() : (sse2() ? *sse2() : scalar());
+    return kernels;
+}
+
+const uint16_t* LineScanner::validMask()
+{
+    return validMaskTable().lanes;
+}
+
+bool LineScanner::checkWin(const PackedBoard& board, int x, int y, int player)
+{
+    const uint16_t* lines = board.lines(player);
+    // 四条线以及(x, y)在线上的位置
+    const int index[4] = {PackedBoard::kRowBase + x,
+                          PackedBoard::kColBase + y,
+                          PackedBoard::kDiagBase + x - y + kSize - 1,
+                          PackedBoard::kAntiDiagBase + x + y};
+    const int pos[4] = {y, x, y, y};
+    for (int i = 0; i < 4; i++)
+    {
+        uint32_t m = lines[index[i]];
+        uint32_t five = m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4); // 第s位表示从s开始的五连
+        int lo = pos[i] >= 4 ? pos[i] - 4 : 0;
+        uint32_t window = ((1u << (pos[i] + 1)) - 1) & ~((1u << lo) - 1);
+        if (five & window)
+            return true;
+    }
+    return false;
+}
+
+void LineScanner::winningMoves(const PackedBoard& board, int player, uint16_t* rows)
+{
+    alignas(32) uint16_t lanes[kLanes];
+    active().winningMoves(board.lines(player), board.lines(1 - player), lanes);
+
+    // 把各方向线上的结果换算回行掩码，通常只有零星几个位，逐位处理即可
+    for (int x = 0; x < kSize; x++)
+        rows[x] = lanes[PackedBoard::kRowBase + x];
+    for (int y = 0; y < kSize; y++)
+    {
+        for (uint32_t m = lanes[PackedBoard::kColBase + y]; m; m &= m - 1)
+            rows[__builtin_ctz(m)] |= static_cast<uint16_t>(1u << y);
+    }
+    for (int d = 0; d < 2 * kSize - 1; d++)
+    {
+        for (uint32_t m = lanes[PackedBoard::kDiagBase + d]; m; m &= m - 1)
+        {
+            int y = __builtin_ctz(m);
+            rows[y + d - (kSize - 1)] |= static_cast<uint16_t>(1u << y);
+        }
+        for (uint32_t m = lanes[PackedBoard::kAntiDiagBase + d]; m; m &= m - 1)
+        {
+            int y = __builtin_ctz(m);
+            rows[d - y] |= static_cast<uint16_t>(1u << y);
+        }
+    }
+}
+
+int LineScanner::bestThreatMove(const PackedBoard& board)
+{
+    // 行掩码补零，核心函数可以直接越界读取r + 1、r + 2行
+    alignas(32) uint16_t humanRows[32] = {0};
+    alignas(32) uint16_t emptyRows[16] = {0};
+    const uint16_t* human = board.lines(PackedBoard::kHuman);
+    const uint16_t* ai = board.lines(PackedBoard::kAi);
+    for (int x = 0; x < kSize; x++)
+    {
+        humanRows[x] = human[PackedBoard::kRowBase + x];
+        emptyRows[x] = static_cast<uint16_t>(~(human[PackedBoard::kRowBase + x] | ai[PackedBoard::kRowBase + x]) & kFullRow);
+    }
+    return active().bestThreat(humanRows, emptyRows);
+}
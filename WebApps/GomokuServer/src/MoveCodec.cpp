@@ -0,0 +1,120 @@
+#include "../include/MoveCodec.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <strings.h>
+
+const char* const MoveCodec::kJsonType = "application/json";
+const char* const MoveCodec::kDeltaType = "application/vnd.gomoku.delta";
+const char* const MoveCodec::kBoardType = "application/vnd.gomoku.board";
+
+namespace
+{
+    std::string trim(const std::string& s, size_t begin, size_t end)
+    {
+        while (begin < end && (s[begin] == ' ' || s[begin] == '\t'))
+            begin++;
+        while (end > begin && (s[end - 1] == ' ' || s[end - 1] == '\t'))
+            end--;
+        return s.substr(begin, end - begin);
+    }
+
+    void writeHeader(std::string& out, const MoveCodec::Outcome& outcome, bool withBoard)
+    {
+        bool hasMove = outcome.lastX >= 0 && outcome.lastY >= 0;
+        out.push_back(static_cast<char>(MoveCodec::kVersion));
+        out.push_back(static_cast<char>(outcome.winner));
+        out.push_back(static_cast<char>(outcome.humanNext ? 1 : 0));
+        out.push_back(static_cast<char>(withBoard ? 1 : 0));
+        out.push_back(static_cast<char>(hasMove ? outcome.lastX : MoveCodec::kNoMove));
+        out.push_back(static_cast<char>(hasMove ? outcome.lastY : MoveCodec::kNoMove));
+    }
+} // namespace
+
+MoveCodec::Format MoveCodec::negotiate(const std::string& accept)
+{
+    Format best = kJson;
+    double bestQ = 0;
+    size_t pos = 0;
+    while (pos < accept.size())
+    {
+        size_t comma = accept.find(',', pos);
+        if (comma == std::string::npos)
+            comma = accept.size();
+
+        // 每一项形如 "type/subtype;q=0.8"
+        size_t semi = accept.find(';', pos);
+        std::string type = trim(accept, pos, semi < comma ? semi : comma);
+        double q = 1.0;
+        for (size_t p = semi; p < comma; p = accept.find(';', p + 1))
+        {
+            std::string param = trim(accept, p + 1, std::min(accept.find(';', p + 1), comma));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+                q = std::atof(param.c_str() + 2);
+        }
+        pos = comma + 1;
+
+        // 媒体类型不区分大小写(RFC 9110)
+        Format format;
+        if (strcasecmp(type.c_str(), kJsonType) == 0)
+            format = kJson;
+        else if (strcasecmp(type.c_str(), kDeltaType) == 0)
+            format = kDelta;
+        else if (strcasecmp(type.c_str(), kBoardType) == 0)
+            format = kPackedBoard;
+        else
+            continue; // 通配符和其他类型不参与比较，只有显式要求二进制格式时才切换
+
+        if (q > bestQ)
+        {
+            best = format;
+            bestQ = q;
+        }
+    }
+    return best;
+}
+
+const char* MoveCodec::contentType(Format format)
+{
+    switch (format)
+    {
+    case kDelta:
+        return kDeltaType;
+    case kPackedBoard:
+        return kBoardType;
+    default:
+        return kJsonType;
+    }
+}
+
+std::string MoveCodec::encodeDelta(const Outcome& outcome)
+{
+    std::string out;
+    out.reserve(kHeaderSize);
+    writeHeader(out, outcome, false);
+    return out;
+}
+
+std::string MoveCodec::encodeBoard(const Outcome& outcome, const PackedBoard& board)
+{
+    std::string out;
+    out.reserve(kHeaderSize + kBoardBytes);
+    writeHeader(out, outcome, true);
+    out.resize(kHeaderSize + kBoardBytes, '\0');
+
+    // 直接从位棋盘的行掩码取子，不需要逐格比较字符串
+    const uint16_t* human = board.lines(PackedBoard::kHuman);
+    const uint16_t* ai = board.lines(PackedBoard::kAi);
+    for (int x = 0; x < PackedBoard::kSize; x++)
+    {
+        for (int y = 0; y < PackedBoard::kSize; y++)
+        {
+            unsigned cell = ((human[PackedBoard::kRowBase + x] >> y) & 1u) |
+                            ((ai[PackedBoard::kRowBase + x] >> y) & 1u) << 1;
+            int index = x * PackedBoard::kSize + y;
+            out[kHeaderSize + index / 4] |= static_cast<char>(cell << (index % 4 * 2));
+        }
+    }
+    return out;
+}
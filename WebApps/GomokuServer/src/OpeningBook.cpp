@@ -0,0 +1,329 @@
+#include "OpeningBook.h"
+#include "AiGame.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <muduo/base/Logging.h>
+
+namespace
+{
+    const char     kMagic[8] = {'G', 'M', 'K', 'B', 'O', 'O', 'K', '1'};
+    const uint32_t kVersion = 1;
+
+    // Zobrist随机表，用固定种子的splitmix64生成，保证每次启动、每台机器结果一致
+    const uint64_t* zobristTable()
+    {
+        static uint64_t table[2 * BOARD_SIZE * BOARD_SIZE];
+        static bool inited = [] {
+            uint64_t seed = 0x9E3779B97F4A7C15ULL;
+            for (auto& v : table)
+            {
+                seed += 0x9E3779B97F4A7C15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                v = z ^ (z >> 31);
+            }
+            return true;
+        }();
+        (void)inited;
+        return table;
+    }
+
+    int sign(int v)
+    {
+        return (v > 0) - (v < 0);
+    }
+} // namespace
+
+OpeningBook::~OpeningBook()
+{
+    unmap();
+}
+
+// 先按需镜像，再顺时针旋转(t % 4)次
+void OpeningBook::transform(int t, int& x, int& y)
+{
+    if (t >= 4)
+        y = BOARD_SIZE - 1 - y;
+    for (int i = 0; i < t % 4; i++)
+    {
+        int nx = y;
+        y = BOARD_SIZE - 1 - x;
+        x = nx;
+    }
+}
+
+// transform的逆过程：先逆时针旋转回来，再撤销镜像
+void OpeningBook::inverseTransform(int t, int& x, int& y)
+{
+    for (int i = 0; i < t % 4; i++)
+    {
+        int nx = BOARD_SIZE - 1 - y;
+        y = x;
+        x = nx;
+    }
+    if (t >= 4)
+        y = BOARD_SIZE - 1 - y;
+}
+
+uint64_t OpeningBook::canonicalKey(const std::vector<Stone>& stones, int& trans)
+{
+    const uint64_t* zobrist = zobristTable();
+    uint64_t best = 0;
+    trans = 0;
+    for (int t = 0; t < 8; t++)
+    {
+        uint64_t h = 0;
+        for (const auto& s : stones)
+        {
+            int x = s.x, y = s.y;
+            transform(t, x, y);
+            h ^= zobrist[s.color * BOARD_SIZE * BOARD_SIZE + x * BOARD_SIZE + y];
+        }
+        if (t == 0 || h < best)
+        {
+            best = h;
+            trans = t;
+        }
+    }
+    return best;
+}
+
+bool OpeningBook::load(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_WARN << "Opening book " << path << " not exist";
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+    {
+        LOG_ERROR << "Opening book " << path << " is too small";
+        ::close(fd);
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // 映射建立后即可关闭文件描述符
+    if (addr == MAP_FAILED)
+    {
+        LOG_ERROR << "mmap opening book " << path << " failed";
+        return false;
+    }
+
+    // 校验文件头和记录数，防止读到损坏或者旧版本的文件
+    const Header* header = static_cast<const Header*>(addr);
+    const Entry* entries = reinterpret_cast<const Entry*>(static_cast<const char*>(addr) + sizeof(Header));
+    bool ok = std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+              header->version == kVersion &&
+              header->boardSize == BOARD_SIZE &&
+              fileSize == sizeof(Header) + header->count * sizeof(Entry);
+    for (uint64_t i = 1; ok && i < header->count; i++)
+    {
+        ok = entries[i - 1].key < entries[i].key;
+    }
+    if (!ok)
+    {
+        LOG_ERROR << "Opening book " << path << " is corrupted or outdated";
+        ::munmap(addr, fileSize);
+        return false;
+    }
+
+    unmap();
+    owned_.clear();
+    owned_.shrink_to_fit();
+    mapped_ = addr;
+    mappedSize_ = fileSize;
+    entries_ = entries;
+    count_ = header->count;
+    maxStones_ = header->maxStones;
+
+    LOG_INFO << "Opening book loaded from " << path << " (" << count_ << " positions)";
+    return true;
+}
+
+bool OpeningBook::save(const std::string& path) const
+{
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.boardSize = BOARD_SIZE;
+    header.count = count_;
+    header.maxStones = maxStones_;
+
+    // 先写临时文件再rename，避免其他进程读到写了一半的文件
+    std::string tmpPath = path + ".tmp";
+    FILE* fp = ::fopen(tmpPath.c_str(), "wb");
+    if (!fp)
+    {
+        LOG_ERROR << "Failed to create opening book " << tmpPath;
+        return false;
+    }
+    bool ok = ::fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              (count_ == 0 || ::fwrite(entries_, sizeof(Entry), count_, fp) == count_);
+    ok = (::fclose(fp) == 0) && ok;
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        LOG_ERROR << "Failed to write opening book " << path;
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void OpeningBook::addLine(const std::vector<Stone>& stones, int x, int y)
+{
+    int trans;
+    Entry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.key = canonicalKey(stones, trans);
+    transform(trans, x, y); // 应手也换算到归一化局面下保存
+    entry.x = static_cast<uint8_t>(x);
+    entry.y = static_cast<uint8_t>(y);
+    entry.stones = static_cast<uint16_t>(stones.size());
+    owned_.push_back(entry);
+}
+
+void OpeningBook::buildDefault()
+{
+    unmap();
+    owned_.clear();
+
+    const int center = BOARD_SIZE / 2;
+
+    // 1. 人类第一手：下在天元则斜向应对，否则向天元方向贴身应对
+    for (int x = 0; x < BOARD_SIZE; x++)
+    {
+        for (int y = 0; y < BOARD_SIZE; y++)
+        {
+            if (x == center && y == center)
+                addLine({{x, y, 0}}, center - 1, center + 1);
+            else
+                addLine({{x, y, 0}}, x + sign(center - x), y + sign(center - y));
+        }
+    }
+
+    // 2. 天元开局、AI斜向应对之后，人类第二手落在天元两格以内
+    const int wx = center - 1, wy = center + 1;
+    for (int dx = -2; dx <= 2; dx++)
+    {
+        for (int dy = -2; dy <= 2; dy++)
+        {
+            int bx = center + dx, by = center + dy;
+            if ((dx == 0 && dy == 0) || (bx == wx && by == wy))
+                continue;
+
+            int rx, ry;
+            if (std::max(std::abs(dx), std::abs(dy)) == 1)
+            {
+                // 与天元连成二：堵住两端中离白子更近的一端
+                int ends[2][2] = {{bx + dx, by + dy}, {center - dx, center - dy}};
+                int best = -1, bestDist = BOARD_SIZE;
+                for (int i = 0; i < 2; i++)
+                {
+                    if (ends[i][0] == wx && ends[i][1] == wy)
+                        continue;
+                    int dist = std::max(std::abs(ends[i][0] - wx), std::abs(ends[i][1] - wy));
+                    if (dist < bestDist)
+                    {
+                        bestDist = dist;
+                        best = i;
+                    }
+                }
+                rx = ends[best][0];
+                ry = ends[best][1];
+            }
+            else if (dx % 2 == 0 && dy % 2 == 0)
+            {
+                // 与天元隔一格在同一条线上：占住中间的空位
+                rx = center + dx / 2;
+                ry = center + dy / 2;
+                if (rx == wx && ry == wy)
+                    continue;
+            }
+            else
+            {
+                continue; // 其他棋形交给搜索
+            }
+            addLine({{center, center, 0}, {wx, wy, 1}, {bx, by, 0}}, rx, ry);
+        }
+    }
+
+    // 对称的局面会生成相同的key，只保留第一条
+    std::stable_sort(owned_.begin(), owned_.end(),
+                     [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    owned_.erase(std::unique(owned_.begin(), owned_.end(),
+                             [](const Entry& a, const Entry& b) { return a.key == b.key; }),
+                 owned_.end());
+
+    maxStones_ = 0;
+    for (const auto& entry : owned_)
+    {
+        maxStones_ = std::max<uint32_t>(maxStones_, entry.stones);
+    }
+    entries_ = owned_.data();
+    count_ = owned_.size();
+    LOG_INFO << "Opening book built from default table (" << count_ << " positions)";
+}
+
+bool OpeningBook::lookup(const std::vector<std::vector<std::string>>& board, int& x, int& y) const
+{
+    if (count_ == 0)
+        return false;
+
+    std::vector<Stone> stones;
+    for (int r = 0; r < BOARD_SIZE; r++)
+    {
+        for (int c = 0; c < BOARD_SIZE; c++)
+        {
+            if (board[r][c] == EMPTY)
+                continue;
+            // 已经超出开局库覆盖的范围，不必再查
+            if (stones.size() >= maxStones_)
+                return false;
+            stones.push_back({r, c, board[r][c] == HUMAN_PLAYER ? 0 : 1});
+        }
+    }
+
+    int trans;
+    uint64_t key = canonicalKey(stones, trans);
+    const Entry* end = entries_ + count_;
+    const Entry* it = std::lower_bound(entries_, end, key,
+                                       [](const Entry& e, uint64_t k) { return e.key < k; });
+    if (it == end || it->key != key || it->stones != stones.size())
+        return false;
+
+    int rx = it->x, ry = it->y;
+    inverseTransform(trans, rx, ry);
+    if (rx < 0 || rx >= BOARD_SIZE || ry < 0 || ry >= BOARD_SIZE || board[rx][ry] != EMPTY)
+        return false;
+
+    x = rx;
+    y = ry;
+    return true;
+}
+
+void OpeningBook::unmap()
+{
+    if (mapped_)
+    {
+        ::munmap(mapped_, mappedSize_);
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+    }
+    entries_ = nullptr;
+    count_ = 0;
+    maxStones_ = 0;
+}
@@ -0,0 +1,78 @@
+#include "../include/PresenceTracker.h"
+
+bool PresenceTracker::login(int userId)
+{
+    Shard& shard = shardFor(userId);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.users.emplace(userId, Clock::now()).second)
+            return false;
+    }
+    updatePeak(current_.fetch_add(1, std::memory_order_relaxed) + 1);
+    return true;
+}
+
+void PresenceTracker::logout(int userId)
+{
+    Shard& shard = shardFor(userId);
+    size_t erased;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        erased = shard.users.erase(userId);
+    }
+    if (erased)
+        current_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void PresenceTracker::touch(int userId)
+{
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.users.find(userId);
+    if (it != shard.users.end())
+        it->second = Clock::now();
+}
+
+bool PresenceTracker::isOnline(int userId)
+{
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.users.count(userId) > 0;
+}
+
+size_t PresenceTracker::expireIdle(int idleSeconds)
+{
+    Clock::time_point deadline = Clock::now() - std::chrono::seconds(idleSeconds);
+    size_t expired = 0;
+    for (auto& shard : shards_)
+    {
+        size_t n = 0;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.users.begin(); it != shard.users.end();)
+            {
+                if (it->second < deadline)
+                {
+                    it = shard.users.erase(it);
+                    n++;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        if (n)
+            current_.fetch_sub(static_cast<int>(n), std::memory_order_relaxed);
+        expired += n;
+    }
+    return expired;
+}
+
+void PresenceTracker::updatePeak(int online)
+{
+    int peak = peak_.load(std::memory_order_relaxed);
+    while (online > peak && !peak_.compare_exchange_weak(peak, online, std::memory_order_relaxed))
+    {
+    }
+}
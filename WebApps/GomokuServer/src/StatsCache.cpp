@@ -0,0 +1,101 @@
+#include "../include/StatsCache.h"
+#include "../include/CredentialService.h"
+
+#include <chrono>
+
+#include <nlohmann/json.hpp>
+
+StatsCache::StatsCache()
+    : userCount_(0)
+    , stop_(false)
+{
+}
+
+StatsCache::~StatsCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (resyncThread_.joinable())
+        resyncThread_.join();
+}
+
+void StatsCache::start(int resyncSeconds)
+{
+    resyncThread_ = std::thread(&StatsCache::resyncLoop, this, resyncSeconds);
+}
+
+void StatsCache::refresh(int curOnline, int maxOnline, const http::ServerStats& server)
+{
+    // 数据库连接池状态，等待时间分布按桶的上界输出，如 "<5ms"
+    http::db::DbPoolStats pool = http::MysqlUtil::poolStats();
+    nlohmann::json histogram;
+    for (size_t i = 0; i < pool.waitHistogram.size(); i++)
+    {
+        std::string bucket = i < pool.kWaitBucketsMs.size()
+                                 ? "<" + std::to_string(pool.kWaitBucketsMs[i]) + "ms"
+                                 : ">=" + std::to_string(pool.kWaitBucketsMs.back()) + "ms";
+        histogram[bucket] = pool.waitHistogram[i];
+    }
+
+    nlohmann::json respBody = {
+        {"curOnline", curOnline},
+        {"maxOnline", maxOnline},
+        {"totalUser", userCount()},
+        {"dbPool", {
+            {"total", pool.total},
+            {"idle", pool.idle},
+            {"waiting", pool.waiting},
+            {"acquired", pool.acquired},
+            {"timeouts", pool.timeouts},
+            {"waitHistogram", histogram}
+        }},
+        {"credential", {
+            {"queued", CredentialService::getInstance().queueSize()},
+            {"rejected", CredentialService::getInstance().rejected()}
+        }},
+        {"server", {
+            {"connections", server.connections},
+            {"inFlight", server.inFlight},
+            {"loops", server.loops},
+            {"rejectedConnections", server.rejectedConnections},
+            {"rejectedRequests", server.rejectedRequests},
+            {"timedOut", server.timedOut}
+        }}
+    };
+    std::atomic_store(&body_, std::shared_ptr<const std::string>(std::make_shared<std::string>(respBody.dump(4))));
+}
+
+void StatsCache::resyncLoop(int resyncSeconds)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_)
+    {
+        lock.unlock();
+        // 与期间的增量更新可能有短暂偏差，下一次校准时修正
+        int count = queryUserCount();
+        if (count >= 0)
+            userCount_.store(count, std::memory_order_relaxed);
+        lock.lock();
+
+        cv_.wait_for(lock, std::chrono::seconds(resyncSeconds), [this] { return stop_; });
+    }
+}
+
+int StatsCache::queryUserCount()
+{
+    try
+    {
+        std::string sql = "SELECT COUNT(*) as count FROM users";
+        return mysqlUtil_.query(sql, [](sql::ResultSet& res) {
+            return res.next() ? res.getInt("count") : -1;
+        });
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR << "Failed to query user count: " << e.what();
+    }
+    return -1;
+}
@@ -0,0 +1,165 @@
+#include "../include/UserCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+
+namespace
+{
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // 把用户名按8字节一组打包，不足补0
+    void packName(const std::string& username, uint64_t out[4])
+    {
+        char buf[32] = {0};
+        std::memcpy(buf, username.data(), username.size());
+        std::memcpy(out, buf, sizeof(buf));
+    }
+} // namespace
+
+UserCache::Digest UserCache::digest(const std::string& password)
+{
+    Digest d;
+    SHA256(reinterpret_cast<const unsigned char*>(password.data()), password.size(), d.data());
+    return d;
+}
+
+bool UserCache::digestEqual(const Digest& a, const Digest& b)
+{
+    return CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+UserCache::Slot& UserCache::slotFor(const std::string& username)
+{
+    size_t h = std::hash<std::string>()(username);
+    return slots_[(h ^ (h >> kSlotBits)) & (kSlotCount - 1)];
+}
+
+UserCache::Lookup UserCache::lookup(const std::string& username, int& userId, Digest& digest)
+{
+    if (username.size() > kMaxUsername)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::kMiss;
+    }
+
+    Slot& slot = slotFor(username);
+    uint64_t words[10];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq & 1) // 正在被写，当作未命中
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::kMiss;
+    }
+    for (int i = 0; i < 10; i++)
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) // 读的过程中被改写过
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::kMiss;
+    }
+
+    uint64_t name[4];
+    packName(username, name);
+    uint64_t meta = words[8];
+    State state = static_cast<State>((meta >> 40) & 0xFF);
+    bool match = state != kEmpty &&
+                 ((meta >> 32) & 0xFF) == username.size() &&
+                 std::memcmp(name, words, sizeof(name)) == 0 &&
+                 static_cast<int64_t>(words[9]) > nowMs();
+    if (!match)
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return Lookup::kMiss;
+    }
+
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    if (state == kNegative)
+        return Lookup::kNotFound;
+    userId = static_cast<int32_t>(meta & 0xFFFFFFFFu);
+    std::memcpy(digest.data(), words + 4, digest.size());
+    return Lookup::kFound;
+}
+
+void UserCache::put(const std::string& username, int userId, const Digest& digest)
+{
+    if (username.size() > kMaxUsername)
+        return;
+    Slot& slot = slotFor(username);
+    uint64_t seq;
+    // 其他线程正在写这个槽，放弃本次写入，缓存不要求每次都写成功
+    if (tryLock(slot, seq))
+        store(slot, seq, username, kPositive, userId, digest, kPositiveTtlSeconds);
+}
+
+uint64_t UserCache::epoch(const std::string& username)
+{
+    if (username.size() > kMaxUsername)
+        return 0;
+    return slotFor(username).epoch.load(std::memory_order_acquire);
+}
+
+void UserCache::putMissing(const std::string& username, uint64_t epoch)
+{
+    if (username.size() > kMaxUsername)
+        return;
+    Slot& slot = slotFor(username);
+    uint64_t seq;
+    if (!tryLock(slot, seq))
+        return;
+    // 持有写权限后再核对代数：在此之前的失效会被发现，在此之后的失效会等本次写完再清空
+    if (slot.epoch.load(std::memory_order_acquire) != epoch)
+    {
+        slot.seq.store(seq + 2, std::memory_order_release);
+        return;
+    }
+    store(slot, seq, username, kNegative, 0, Digest{}, kNegativeTtlSeconds);
+}
+
+void UserCache::invalidate(const std::string& username)
+{
+    if (username.size() > kMaxUsername)
+        return;
+    Slot& slot = slotFor(username);
+    // 先推进代数，让正在查库的putMissing作废；清空不能放弃，否则刚注册的用户会被旧的负缓存挡住
+    // 直接清空对应的槽，即使槽里是映射到同一位置的其他用户，代价也只是多一次未命中
+    slot.epoch.fetch_add(1, std::memory_order_acq_rel);
+    uint64_t seq;
+    while (!tryLock(slot, seq))
+        std::this_thread::yield();
+    store(slot, seq, username, kEmpty, 0, Digest{}, 0);
+}
+
+bool UserCache::tryLock(Slot& slot, uint64_t& seq)
+{
+    seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acq_rel))
+        return false;
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+void UserCache::store(Slot& slot, uint64_t seq, const std::string& username, State state, int userId,
+                      const Digest& digest, int ttlSeconds)
+{
+    uint64_t words[10];
+    packName(username, words);
+    std::memcpy(words + 4, digest.data(), digest.size());
+    words[8] = static_cast<uint32_t>(userId) |
+               (static_cast<uint64_t>(username.size()) << 32) |
+               (static_cast<uint64_t>(state) << 40);
+    words[9] = static_cast<uint64_t>(nowMs() + ttlSeconds * 1000LL);
+    for (int i = 0; i < 10; i++)
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
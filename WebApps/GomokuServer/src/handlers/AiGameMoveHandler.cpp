@@ -8,11 +8,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
         if (session->getValue("isLoggedIn") != "true")
         {
             // 用户未登录，返回未授权错误
-            json errorResp;
-            errorResp["status"] = "error";
-            errorResp["message"] = "Unauthorized";
-            std::string errorBody = errorResp.dump(4);
-
+            const std::string &errorBody = ErrorBodies::unauthorized();
             server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                                  "Unauthorized", true, "application/json", errorBody.size(),
                                  errorBody, resp);
@@ -20,27 +16,20 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
         }
 
         int userId = std::stoi(session->getValue("userId"));
+        server_->onlineUsers_.touch(userId);
         // 解析请求体
         json request = json::parse(req.getBody());
         int x = request["x"];
         int y = request["y"];
 
-        // 获取或创建游戏实例
-        if (server_->aiGames_.find(userId) == server_->aiGames_.end())
-        {
-            std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-            server_->aiGames_[userId] = std::make_shared<AiGame>(userId);
-        }
-        auto &game = server_->aiGames_[userId];
+        // 获取或创建游戏实例，并锁住本局的回合，防止同一用户的并发请求交错落子
+        auto game = server_->aiGames_.getOrCreate(userId);
+        auto turn = game->lockTurn();
 
         // 处理人类玩家移动
         if (!game->humanMove(x, y))
         {
-            json response = {
-                {"status", "error"},
-                {"message", "Invalid move"}};
-            std::string responseBody = response.dump();
-
+            const std::string &responseBody = ErrorBodies::invalidMove();
             resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
@@ -49,125 +38,107 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
             return;
         }
 
+        // 按Accept头选择响应格式，默认仍然返回JSON
+        MoveCodec::Format format = MoveCodec::negotiate(req.getHeader(http::HttpHeaders::kAccept));
+        MoveCodec::Outcome outcome;
+
         // 检查人类玩家是否获胜
         if (game->isGameOver())
         {
-            json response = {
-                {"status", "ok"},
-                {"board", game->getBoard()},
-                {"winner", "human"},
-                {"next_turn", "none"}};
-            std::string responseBody = response.dump();
-
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-            resp->setCloseConnection(false);
-            resp->setContentType("application/json");
-            resp->setContentLength(responseBody.size());
-            resp->setBody(responseBody);
-
-            {
-                std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-                server_->aiGames_.erase(userId); // 这里删掉以后，每次restart都需要重新创建就行
-            }
+            outcome.winner = MoveCodec::kHuman;
+            respondMove(req.getVersion(), format, *game, outcome, resp);
+            server_->aiGames_.erase(userId, game); // 这里删掉以后，每次restart都需要重新创建就行
             return;
         }
 
         // 检查是否平局（在AI移动之前）
         if (game->isDraw())
         {
-            json response = {
-                {"status", "ok"},
-                {"board", game->getBoard()},
-                {"winner", "draw"},
-                {"next_turn", "none"}};
-            std::string responseBody = response.dump();
-
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-            resp->setCloseConnection(false);
-            resp->setContentType("application/json");
-            resp->setContentLength(responseBody.size());
-            resp->setBody(responseBody);
-
-            {
-                std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-                server_->aiGames_.erase(userId); // 这里删掉以后，每次restart都需要重新创建就行
-            }
+            outcome.winner = MoveCodec::kDraw;
+            respondMove(req.getVersion(), format, *game, outcome, resp);
+            server_->aiGames_.erase(userId, game); // 这里删掉以后，每次restart都需要重新创建就行
             return;
         }
 
         // AI移动
         game->aiMove();
+        outcome.lastX = game->getLastMove().first;
+        outcome.lastY = game->getLastMove().second;
 
-        // 检查AI是否获胜
-        if (game->isGameOver())
-        {
-            json response = {
-                {"status", "ok"},
-                {"board", game->getBoard()},
-                {"winner", "ai"},
-                {"next_turn", "none"},
-                {"last_move", {{"x", game->getLastMove().first}, {"y", game->getLastMove().second}}}};
-            std::string responseBody = response.dump();
-
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-            resp->setCloseConnection(false);
-            resp->setContentType("application/json");
-            resp->setContentLength(responseBody.size());
-            resp->setBody(responseBody);
-
-            {
-                std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-                server_->aiGames_.erase(userId); // 这里删掉以后，每次restart都需要重新创建就行
-            }
-            return;
-        }
-
-        // 再次检查是否平局（在AI移动之后）
-        if (game->isDraw())
+        // 检查AI是否获胜，再次检查是否平局（在AI移动之后）
+        if (game->isGameOver() || game->isDraw())
         {
-            json response = {
-                {"status", "ok"},
-                {"board", game->getBoard()},
-                {"winner", "draw"},
-                {"next_turn", "none"},
-                {"last_move", {{"x", game->getLastMove().first}, {"y", game->getLastMove().second}}}};
-            std::string responseBody = response.dump();
-
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-            resp->setCloseConnection(false);
-            resp->setContentType("application/json");
-            resp->setContentLength(responseBody.size());
-            resp->setBody(responseBody);
-
-            {
-                std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-                server_->aiGames_.erase(userId); // 这里删掉以后，每次restart都需要重新创建就行
-            }
+            outcome.winner = game->isGameOver() ? MoveCodec::kAi : MoveCodec::kDraw;
+            respondMove(req.getVersion(), format, *game, outcome, resp);
+            server_->aiGames_.erase(userId, game); // 这里删掉以后，每次restart都需要重新创建就行
             return;
         }
 
         // 游戏继续
-        json response = {
-            {"status", "ok"},
-            {"board", game->getBoard()},
-            {"winner", "none"},
-            {"next_turn", "human"},
-            {"last_move", {{"x", game->getLastMove().first}, {"y", game->getLastMove().second}}}};
-
-        std::string responseBody = response.dump();
-
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-        resp->setCloseConnection(false);
-        resp->setContentType("application/json");
-        resp->setContentLength(responseBody.size());
-        resp->setBody(responseBody);
+        outcome.humanNext = true;
+        respondMove(req.getVersion(), format, *game, outcome, resp);
     }
     catch (const std::exception &e)
     { 
-        json response = {
-            {"status", "error"},
-            {"message", e.what()}};
-        std::string responseBody = response.dump();
+        std::string responseBody = JsonWriter::errorBody(e.what());
         server_->packageResp(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error", false, "application/json", responseBody.size(), responseBody, resp);
     }
+}
+
+void AiGameMoveHandler::respondMove(const std::string &version, MoveCodec::Format format, const AiGame &game,
+                                    const MoveCodec::Outcome &outcome, http::HttpResponse *resp)
+{
+    resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
+    resp->setCloseConnection(false);
+    resp->setContentType(MoveCodec::contentType(format));
+    // 响应内容随Accept头变化，告诉中间缓存按Accept区分
+    resp->addHeader("Vary", "Accept");
+
+    if (format == MoveCodec::kDelta)
+    {
+        resp->setBody(MoveCodec::encodeDelta(outcome));
+    }
+    else if (format == MoveCodec::kPackedBoard)
+    {
+        resp->setBody(MoveCodec::encodeBoard(outcome, game.getPackedBoard()));
+    }
+    else
+    {
+        // 直接写入响应体，棋盘从位棋盘的行掩码取子，不再逐格构造json节点
+        static const char *const kWinners[] = {"none", "human", "ai", "draw"};
+        std::string *body = resp->mutableBody();
+        body->clear();
+        body->reserve(4096);
+        JsonWriter writer(body);
+        writer.beginObject().field("status", "ok").key("board").beginArray();
+        const PackedBoard &board = game.getPackedBoard();
+        const uint16_t *human = board.lines(PackedBoard::kHuman);
+        const uint16_t *ai = board.lines(PackedBoard::kAi);
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            writer.beginArray();
+            for (int y = 0; y < BOARD_SIZE; y++)
+            {
+                if ((human[PackedBoard::kRowBase + x] >> y) & 1u)
+                    writer.value(HUMAN_PLAYER);
+                else if ((ai[PackedBoard::kRowBase + x] >> y) & 1u)
+                    writer.value(AI_PLAYER);
+                else
+                    writer.value(EMPTY);
+            }
+            writer.endArray();
+        }
+        writer.endArray()
+              .field("winner", kWinners[outcome.winner])
+              .field("next_turn", outcome.humanNext ? "human" : "none");
+        if (outcome.lastX >= 0)
+        {
+            writer.key("last_move").beginObject()
+                  .field("x", outcome.lastX)
+                  .field("y", outcome.lastY)
+                  .endObject();
+        }
+        writer.endObject();
+    }
+    resp->setContentLength(resp->mutableBody()->size());
 }
\ No newline at end of file
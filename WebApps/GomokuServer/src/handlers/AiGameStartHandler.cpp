@@ -6,11 +6,7 @@ void AiGameStartHandler::handle(const http::HttpRequest &req, http::HttpResponse
     if (session->getValue("isLoggedIn") != "true")
     {
         // 用户未登录，返回未授权错误
-        json errorResp;
-        errorResp["status"] = "error";
-        errorResp["message"] = "Unauthorized";
-        std::string errorBody = errorResp.dump(4);
-
+        const std::string &errorBody = ErrorBodies::unauthorized();
         server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                              "Unauthorized", true, "application/json", errorBody.size(),
                              errorBody, resp);
@@ -18,14 +14,10 @@ void AiGameStartHandler::handle(const http::HttpRequest &req, http::HttpResponse
     }
 
     int userId = std::stoi(session->getValue("userId"));
+    server_->onlineUsers_.touch(userId);
 
     // 看来需要menu页面post发送userId
-    {
-        std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-        if (server_->aiGames_.find(userId) != server_->aiGames_.end())
-            server_->aiGames_.erase(userId);
-        server_->aiGames_[userId] = std::make_shared<AiGame>(userId);
-    }
+    server_->aiGames_.reset(userId);
 
     // 创建一个ai机器人，它就while不断地执行下棋逻辑
     std::string reqFile("../WebApps/GomokuServer/resource/ChessGameVsAi.html");
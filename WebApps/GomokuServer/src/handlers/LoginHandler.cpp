@@ -1,10 +1,20 @@
 #include "../include/handlers/LoginHandler.h"
 
+namespace
+{
+    // users表中登录需要的列
+    struct UserRow
+    {
+        int32_t     id = -1;
+        std::string password;
+    };
+} // namespace
+
 void LoginHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp)
 {
     // 处理登录逻辑
     // 验证 contentType
-    auto contentType = req.getHeader("Content-Type");
+    const std::string &contentType = req.getHeader(http::HttpHeaders::kContentType);
     if (contentType.empty() || contentType != "application/json" || req.getBody().empty())
     {
         LOG_INFO << "content" << req.getBody();
@@ -22,86 +32,104 @@ void LoginHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp
         json parsed = json::parse(req.getBody());
         std::string username = parsed["username"];
         std::string password = parsed["password"];
-        // 验证用户是否存在
-        int userId = queryUserId(username, password);
-        if (userId != -1)
-        {
-            // 获取会话
-            auto session = server_->getSessionManager()->getSession(req, resp);
-            // 会话都不是同一个会话，因为会话判断是不是同一个会话是通过请求报文中的cookie来判断的
-            // 所以不同页面的访问是不可能是相同的会话的，只有该页面前面访问过服务端，才会有会话记录
-            // 那么判断用户是否在其他地方登录中不能通过会话来判断
-            
-            // 在会话中存储用户信息
-            session->setValue("userId", std::to_string(userId));
-            session->setValue("username", username);
-            session->setValue("isLoggedIn", "true");
-            if (server_->onlineUsers_.find(userId) == server_->onlineUsers_.end() || server_->onlineUsers_[userId] == false)
-            {
+        // 获取会话
+        auto session = server_->getSessionManager()->getSession(req, resp);
+        std::string version = req.getVersion();
+
+        // 查询数据库放到数据库线程池中执行，校验密码放到哈希线程池中执行，都不阻塞IO线程
+        // 全部完成后回到IO线程发送响应
+        auto sender = resp->startAsync();
+        auto reply = [this, sender, session, version, username](int userId, const std::string &error) {
+            sender([this, session, version, username, userId, error](http::HttpResponse *resp) {
+                if (!error.empty())
+                    respondError(version, error, resp);
+                else if (userId == kServerBusy)
+                    respondBusy(version, resp);
+                else
+                    respondLogin(version, session, username, userId, resp);
+            });
+        };
+        http::MysqlUtil::runAsync(
+            [this, username, password]() { return loadCredential(username, password); },
+            [this, reply, username, password](std::future<StoredCredential> result) {
+                StoredCredential cred;
+                try
                 {
-                    std::lock_guard<std::mutex> lock(server_->mutexForOnlineUsers_);
-                    server_->onlineUsers_[userId] = true;
+                    cred = result.get();
                 }
-                
-                // 更新历史最高在线人数
-                server_->updateMaxOnline(server_->onlineUsers_.size());
-                // 用户存在登录成功
-                // 封装json 数据。
-                json successResp;
-                successResp["success"] = true;
-                successResp["userId"] = userId;
-                std::string successBody = successResp.dump(4);
-
-                resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
-                resp->setCloseConnection(false);
-                resp->setContentType("application/json");
-                resp->setContentLength(successBody.size());
-                resp->setBody(successBody);
-                return;
-            }
-            else
-            {
-                // FIXME: 当前该用户正在其他地方登录中，将原有登录用户强制下线更好
-                // 不允许重复登录，
-                json failureResp;
-                failureResp["success"] = false;
-                failureResp["error"] = "账号已在其他地方登录";
-                std::string failureBody = failureResp.dump(4);
-
-                resp->setStatusLine(req.getVersion(), http::HttpResponse::k403Forbidden, "Forbidden");
-                resp->setCloseConnection(true);
-                resp->setContentType("application/json");
-                resp->setContentLength(failureBody.size());
-                resp->setBody(failureBody);
-                return;
-            }
-        }
-        else // 账号密码错误，请重新登录
+                catch (const std::exception &e)
+                {
+                    reply(-1, e.what());
+                    return;
+                }
+                // 缓存已经给出结论，不需要再算哈希
+                if (cred.resolved)
+                {
+                    reply(cred.userId, "");
+                    return;
+                }
+                verifyCredential(cred, username, password, reply);
+            });
+    }
+    catch (const std::exception &e)
+    {
+        respondError(req.getVersion(), e.what(), resp);
+    }
+}
+
+void LoginHandler::respondLogin(const std::string &version, std::shared_ptr<http::session::Session> session,
+                                const std::string &username, int userId, http::HttpResponse *resp)
+{
+    // 验证用户是否存在
+    if (userId != -1)
+    {
+        // 会话都不是同一个会话，因为会话判断是不是同一个会话是通过请求报文中的cookie来判断的
+        // 所以不同页面的访问是不可能是相同的会话的，只有该页面前面访问过服务端，才会有会话记录
+        // 那么判断用户是否在其他地方登录中不能通过会话来判断
+        
+        // 在会话中存储用户信息
+        session->setValue("userId", std::to_string(userId));
+        session->setValue("username", username);
+        session->setValue("isLoggedIn", "true");
+        // 标记上线，同时更新当前和历史最高在线人数
+        if (server_->onlineUsers_.login(userId))
         {
-            // 封装json数据
-            json failureResp;
-            failureResp["status"] = "error";
-            failureResp["message"] = "Invalid username or password";
-            std::string failureBody = failureResp.dump(4);
+            // 用户存在登录成功
+            // 封装json 数据。
+            std::string successBody;
+            JsonWriter(&successBody).beginObject()
+                                    .field("success", true)
+                                    .field("userId", userId)
+                                    .endObject();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k401Unauthorized, "Unauthorized");
+            resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
+            resp->setContentLength(successBody.size());
+            resp->setBody(successBody);
+            return;
+        }
+        else
+        {
+            // FIXME: 当前该用户正在其他地方登录中，将原有登录用户强制下线更好
+            // 不允许重复登录，
+            const std::string &failureBody = ErrorBodies::alreadyLoggedIn();
+
+            resp->setStatusLine(version, http::HttpResponse::k403Forbidden, "Forbidden");
+            resp->setCloseConnection(true);
+            resp->setContentType("application/json");
             resp->setContentLength(failureBody.size());
             resp->setBody(failureBody);
             return;
         }
     }
-    catch (const std::exception &e)
+    else // 账号密码错误，请重新登录
     {
-        // 捕获异常，返回错误信息
-        json failureResp;
-        failureResp["status"] = "error";
-        failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        // 封装json数据
+        const std::string &failureBody = ErrorBodies::invalidCredentials();
 
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
-        resp->setCloseConnection(true);
+        resp->setStatusLine(version, http::HttpResponse::k401Unauthorized, "Unauthorized");
+        resp->setCloseConnection(false);
         resp->setContentType("application/json");
         resp->setContentLength(failureBody.size());
         resp->setBody(failureBody);
@@ -109,19 +137,121 @@ void LoginHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp
     }
 }
 
-int LoginHandler::queryUserId(const std::string &username, const std::string &password)
+void LoginHandler::respondError(const std::string &version, const std::string &message, http::HttpResponse *resp)
 {
-    // 前端用户传来账号密码，查找数据库是否有该账号密码
+    // 捕获异常，返回错误信息
+    std::string failureBody = JsonWriter::errorBody(message);
+
+    resp->setStatusLine(version, http::HttpResponse::k400BadRequest, "Bad Request");
+    resp->setCloseConnection(true);
+    resp->setContentType("application/json");
+    resp->setContentLength(failureBody.size());
+    resp->setBody(failureBody);
+}
+
+void LoginHandler::respondBusy(const std::string &version, http::HttpResponse *resp)
+{
+    const std::string &failureBody = ErrorBodies::serverBusy();
+
+    resp->setStatusLine(version, http::HttpResponse::k503ServiceUnavailable, "Service Unavailable");
+    resp->setCloseConnection(false);
+    resp->addHeader("Retry-After", "1");
+    resp->setContentType("application/json");
+    resp->setContentLength(failureBody.size());
+    resp->setBody(failureBody);
+}
+
+LoginHandler::StoredCredential LoginHandler::loadCredential(const std::string &username, const std::string &password)
+{
+    // 先查用户缓存，缓存中保存的是上次校验通过的密码摘要，命中时直接比对，不访问数据库也不算scrypt
+    StoredCredential cred;
+    UserCache::Digest cached;
+    UserCache::Lookup result = UserCache::getInstance().lookup(username, cred.userId, cached);
+    if (result == UserCache::Lookup::kFound)
+    {
+        cred.resolved = true;
+        if (!UserCache::digestEqual(cached, UserCache::digest(password)))
+            cred.userId = -1;
+        return cred;
+    }
+    if (result == UserCache::Lookup::kNotFound)
+    {
+        cred.resolved = true;
+        cred.userId = -1;
+        return cred;
+    }
+
+    // 前端用户传来账号密码，按用户名查找数据库，取回存储的密码哈希
     // 使用预处理语句, 防止sql注入
-    std::string sql = "SELECT id FROM users WHERE username = ? AND password = ?";
-    // std::vector<std::string> params = {username, password};
-    sql::ResultSet* res = mysqlUtil_.executeQuery(sql, username, password);
-    if (res->next())
+    std::string sql = "SELECT id, password FROM users WHERE username = ?";
+    // 查询期间该用户可能刚好注册成功，注册时的失效会让这次的负缓存作废
+    uint64_t epoch = UserCache::getInstance().epoch(username);
+    // 用户名唯一，最多一行；使用连接上缓存的预处理语句，一次往返
+    UserRow row;
+    bool found = mysqlUtil_.query(sql, [&row](sql::ResultSet& res) {
+        if (!res.next())
+            return false;
+        row.id = res.getInt("id");
+        row.password = res.getString("password");
+        return true;
+    }, username);
+    if (found)
     {
-        int id = res->getInt("id");
-        return id;
+        cred.userId = row.id;
+        cred.stored = row.password;
     }
-    // 如果查询结果为空，则返回-1
-    return -1;
+
+    // 用户不存在，则返回-1
+    if (!found)
+    {
+        UserCache::getInstance().putMissing(username, epoch);
+        cred.resolved = true;
+        cred.userId = -1;
+    }
+    return cred;
+}
+
+void LoginHandler::verifyCredential(const StoredCredential &cred, const std::string &username,
+                                    const std::string &password, const Reply &reply)
+{
+    CredentialService &credentials = CredentialService::getInstance();
+    bool accepted = credentials.verifyAsync(password, cred.stored, [this, cred, username, password, reply](bool matched) {
+        // 密码错误，则返回-1
+        if (!matched)
+        {
+            reply(-1, "");
+            return;
+        }
+        UserCache::getInstance().put(username, cred.userId, UserCache::digest(password));
+        // 旧的明文密码或者成本参数过低的哈希，趁登录成功时升级
+        if (CredentialService::getInstance().needsRehash(cred.stored))
+            upgradePassword(cred.userId, password);
+        reply(cred.userId, "");
+    });
+    // 哈希线程池已满，直接告诉客户端稍后重试
+    if (!accepted)
+        reply(kServerBusy, "");
 }
 
+void LoginHandler::upgradePassword(int userId, const std::string &password)
+{
+    // 在哈希线程中调用，重新计算哈希后交给数据库线程写回，失败只记录日志，下次登录再试
+    std::string hash = CredentialService::getInstance().hash(password);
+    if (hash.empty())
+        return;
+    http::MysqlUtil::runAsync(
+        [this, userId, hash]() {
+            std::string sql = "UPDATE users SET password = ? WHERE id = ?";
+            return mysqlUtil_.executeUpdate(sql, hash, userId);
+        },
+        [userId](std::future<int> result) {
+            try
+            {
+                result.get();
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR << "Upgrade password hash for user " << userId << " failed: " << e.what();
+            }
+        });
+}
@@ -2,7 +2,7 @@
 
 void LogoutHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp)
 {
-    auto contentType = req.getHeader("Content-Type");
+    const std::string &contentType = req.getHeader(http::HttpHeaders::kContentType);
     if (contentType.empty() || contentType != "application/json" || req.getBody().empty())
     {
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
@@ -28,14 +28,11 @@ void LogoutHandler::handle(const http::HttpRequest &req, http::HttpResponse *res
         json parsed = json::parse(req.getBody());
         int gameType = parsed["gameType"]; // fixme: 以后也换成从会话中获取
         
-        {   // 释放资源
-            std::lock_guard<std::mutex> lock(server_->mutexForOnlineUsers_);
-            server_->onlineUsers_.erase(userId);
-        }
+        // 释放资源
+        server_->onlineUsers_.logout(userId);
 
         if (gameType == GomokuServer::MAN_VS_AI)
         {
-            std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
             server_->aiGames_.erase(userId);
         }
         else if (gameType == GomokuServer::MAN_VS_MAN)
@@ -44,9 +41,11 @@ void LogoutHandler::handle(const http::HttpRequest &req, http::HttpResponse *res
         }
 
         // 返回响应报文
-        json response;
-        response["message"] = "logout successful";
-        std::string responseBody = response.dump(4);
+        static const std::string responseBody = [] {
+            std::string body;
+            JsonWriter(&body).beginObject().field("message", "logout successful").endObject();
+            return body;
+        }();
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -56,10 +55,7 @@ void LogoutHandler::handle(const http::HttpRequest &req, http::HttpResponse *res
     catch (const std::exception &e)
     {
         // 捕获异常，返回错误信息
-        json failureResp;
-        failureResp["status"] = "error";
-        failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = JsonWriter::errorBody(e.what());
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
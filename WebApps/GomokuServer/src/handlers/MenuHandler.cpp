@@ -11,11 +11,7 @@ void MenuHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp)
         if (session->getValue("isLoggedIn") != "true")
         {
             // 用户未登录，返回未授权错误
-            json errorResp;
-            errorResp["status"] = "error";
-            errorResp["message"] = "Unauthorized";
-            std::string errorBody = errorResp.dump(4);
-
+            const std::string &errorBody = ErrorBodies::unauthorized();
             server_->packageResp(req.getVersion(), http::HttpResponse::k401Unauthorized,
                                 "Unauthorized", true, "application/json", errorBody.size(),
                                  errorBody, resp);
@@ -57,10 +53,7 @@ void MenuHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp)
     catch (const std::exception &e)
     {
         // 捕获异常，返回错误信息
-        json failureResp;
-        failureResp["status"] = "error";
-        failureResp["message"] = e.what();
-        std::string failureBody = failureResp.dump(4);
+        std::string failureBody = JsonWriter::errorBody(e.what());
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -6,20 +6,82 @@ void RegisterHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
     json parsed = json::parse(req.getBody());
     std::string username = parsed["username"];
     std::string password = parsed["password"];
+    std::string version = req.getVersion();
+
+    // 缓存中确定已存在的用户直接返回，不必计算哈希，也不访问数据库
+    int cachedId;
+    UserCache::Digest cachedDigest;
+    if (UserCache::getInstance().lookup(username, cachedId, cachedDigest) == UserCache::Lookup::kFound)
+    {
+        respondRegister(version, -1, "", resp);
+        return;
+    }
+
+    // 先在哈希线程池中计算密码哈希，再把数据库操作放到数据库线程池中执行，完成后回到IO线程发送响应
+    auto sender = resp->startAsync();
+    bool accepted = CredentialService::getInstance().hashAsync(password, [this, sender, version, username](const std::string& hash) {
+        if (hash.empty())
+        {
+            sender([this, version](http::HttpResponse* resp) {
+                respondRegister(version, -1, "Failed to hash password", resp);
+            });
+            return;
+        }
+        http::MysqlUtil::runAsync(
+            [this, username, hash]() { return insertUser(username, hash); },
+            [this, sender, version](std::future<int> result) {
+                int userId = -1;
+                std::string error;
+                try
+                {
+                    userId = result.get();
+                }
+                catch (const std::exception& e)
+                {
+                    error = e.what();
+                }
+                sender([this, version, userId, error](http::HttpResponse* resp) {
+                    respondRegister(version, userId, error, resp);
+                });
+            });
+    });
+    // 哈希线程池已满，直接告诉客户端稍后重试
+    if (!accepted)
+    {
+        sender([this, version](http::HttpResponse* resp) {
+            respondBusy(version, resp);
+        });
+    }
+}
+
+void RegisterHandler::respondRegister(const std::string& version, int userId, const std::string& error, http::HttpResponse* resp)
+{
+    if (!error.empty())
+    {
+        std::string failureBody = JsonWriter::errorBody(error);
+
+        resp->setStatusLine(version, http::HttpResponse::k500InternalServerError, "Internal Server Error");
+        resp->setCloseConnection(true);
+        resp->setContentType("application/json");
+        resp->setContentLength(failureBody.size());
+        resp->setBody(failureBody);
+        return;
+    }
 
     // 判断用户是否已经存在，如果存在则注册失败
-    int userId = insertUser(username, password);
     if (userId != -1)
     {
         // 插入成功
+        server_->statsCache_.addUser();
         // 封装成功响应
-        json successResp;   
-        successResp["status"] = "success";
-        successResp["message"] = "Register successful";
-        successResp["userId"] = userId;
-        std::string successBody = successResp.dump(4);
+        std::string successBody;
+        JsonWriter(&successBody).beginObject()
+                                .field("status", "success")
+                                .field("message", "Register successful")
+                                .field("userId", userId)
+                                .endObject();
 
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+        resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(false);
         resp->setContentType("application/json");
         resp->setContentLength(successBody.size());
@@ -28,12 +90,9 @@ void RegisterHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
     else
     {
         // 插入失败
-        json failureResp;
-        failureResp["status"] = "error";
-        failureResp["message"] = "username already exists";
-        std::string failureBody = failureResp.dump(4);
+        const std::string &failureBody = ErrorBodies::usernameExists();
 
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k409Conflict, "Conflict");
+        resp->setStatusLine(version, http::HttpResponse::k409Conflict, "Conflict");
         resp->setCloseConnection(false);
         resp->setContentType("application/json");
         resp->setContentLength(failureBody.size());
@@ -41,31 +100,30 @@ void RegisterHandler::handle(const http::HttpRequest& req, http::HttpResponse* r
     }
 }
 
-int RegisterHandler::insertUser(const std::string &username, const std::string &password)
+void RegisterHandler::respondBusy(const std::string& version, http::HttpResponse* resp)
 {
-    // 判断用户是否存在，如果存在则返回-1，否则返回用户id
-    if (!isUserExist(username))
-    {
-        // 用户不存在，插入用户
-        std::string sql = "INSERT INTO users (username, password) VALUES ('" + username + "', '" + password + "')";
-        mysqlUtil_.executeUpdate(sql);
-        std::string sql2 = "SELECT id FROM users WHERE username = '" + username + "'";
-        sql::ResultSet* res = mysqlUtil_.executeQuery(sql2);
-        if (res->next())
-        {
-            return res->getInt("id");
-        }
-    }
-    return -1;
+    const std::string &failureBody = ErrorBodies::serverBusy();
+
+    resp->setStatusLine(version, http::HttpResponse::k503ServiceUnavailable, "Service Unavailable");
+    resp->setCloseConnection(false);
+    resp->addHeader("Retry-After", "1");
+    resp->setContentType("application/json");
+    resp->setContentLength(failureBody.size());
+    resp->setBody(failureBody);
 }
 
-bool RegisterHandler::isUserExist(const std::string &username)
+int RegisterHandler::insertUser(const std::string &username, const std::string &passwordHash)
 {
-    std::string sql = "SELECT id FROM users WHERE username = '" + username + "'";
-    sql::ResultSet* res = mysqlUtil_.executeQuery(sql);
-    if (res->next())
-    {
-        return true;
-    }
-    return false;
-}
\ No newline at end of file
+    // 判断用户是否存在，如果存在则返回-1，否则返回用户id
+    // 检查和插入合成一条语句，并在同一连接上取回自增id，不再分三次借还连接
+    // 使用占位符而不是拼接，既防止sql注入，也让语句可以被连接上的预处理语句缓存复用
+    std::string sql = "INSERT INTO users (username, password) "
+                      "SELECT ?, ? FROM DUAL "
+                      "WHERE NOT EXISTS (SELECT 1 FROM users WHERE username = ?)";
+    uint64_t id = mysqlUtil_.executeInsert(sql, username, passwordHash, username);
+    if (id == 0)
+        return -1;
+    // 清掉可能存在的负缓存，新用户可以立即登录
+    UserCache::getInstance().invalidate(username);
+    return static_cast<int>(id);
+}
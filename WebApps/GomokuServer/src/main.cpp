@@ -1,3 +1,4 @@
+#include <csignal>
 #include <string>
 #include <iostream>
 #include <muduo/net/TcpServer.h>
@@ -12,10 +13,13 @@ int main(int argc, char* argv[])
   
   std::string serverName = "HttpServer";
   int port = 80;
+  bool reusePort = false;   // -r: 每个IO线程各自监听端口
+  bool cpuAffinity = false; // -a: IO线程绑定CPU核
+  std::string handoffPath;  // -u: 重启时交接监听套接字的Unix域套接字路径
   
   // 参数解析
   int opt;
-  const char* str = "p:";
+  const char* str = "p:rau:";
   while ((opt = getopt(argc, argv, str)) != -1)
   {
     switch (opt)
@@ -25,13 +29,40 @@ int main(int argc, char* argv[])
         port = atoi(optarg);
         break;
       }
+      case 'r':
+      {
+        reusePort = true;
+        break;
+      }
+      case 'a':
+      {
+        cpuAffinity = true;
+        break;
+      }
+      case 'u':
+      {
+        handoffPath = optarg;
+        break;
+      }
       default:
         break;
     }
   }
   
   muduo::Logger::setLogLevel(muduo::Logger::INFO);
-  GomokuServer server(port, serverName);
+  GomokuServer server(port, serverName,
+                      reusePort ? muduo::net::TcpServer::kReusePort : muduo::net::TcpServer::kNoReusePort);
   server.setThreadNum(4);
+  server.setReusePortListeners(reusePort);
+  server.setCpuAffinity(cpuAffinity);
+  if (!handoffPath.empty())
+  {
+    server.setHandoffPath(handoffPath);
+  }
+
+  // SIGTERM/SIGINT触发优雅退出：停止accept，处理完正在进行的请求后退出
+  auto onStopSignal = [](int) { http::HttpServer::requestStop(); };
+  ::signal(SIGTERM, onStopSignal);
+  ::signal(SIGINT, onStopSignal);
   server.start();
 }
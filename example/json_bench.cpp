@@ -0,0 +1,105 @@
+// JSON序列化基准测试：比较nlohmann::json构建后dump(4)、dump()与JsonWriter直接写入的耗时和输出大小
+// 用例为 /aiBot/move 的完整棋盘响应和未登录时的错误响应，并校验三种方式解析后的内容一致
+// 编译：cmake -DBUILD_BENCHMARKS=ON .. && make json_bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "utils/JsonWriter.h"
+
+static const int kSize = 15;
+static const char* const kCells[] = {"empty", "black", "white"};
+
+using Board = std::vector<std::vector<std::string>>;
+
+static Board makeBoard()
+{
+    Board board(kSize, std::vector<std::string>(kSize, kCells[0]));
+    for (int i = 0; i < 60; i++)
+        board[rand() % kSize][rand() % kSize] = kCells[1 + i % 2];
+    return board;
+}
+
+// 原来的写法：构建json树后格式化输出
+static std::string moveWithDump(const Board& board, int indent)
+{
+    nlohmann::json response = {
+        {"status", "ok"},
+        {"board", board},
+        {"winner", "none"},
+        {"next_turn", "human"},
+        {"last_move", {{"x", 7}, {"y", 8}}}};
+    return response.dump(indent);
+}
+
+static void moveWithWriter(const Board& board, std::string* body)
+{
+    body->clear();
+    JsonWriter writer(body);
+    writer.beginObject().field("status", "ok").key("board").beginArray();
+    for (const auto& row : board)
+    {
+        writer.beginArray();
+        for (const auto& cell : row)
+            writer.value(cell);
+        writer.endArray();
+    }
+    writer.endArray()
+          .field("winner", "none")
+          .field("next_turn", "human")
+          .key("last_move").beginObject().field("x", 7).field("y", 8).endObject()
+          .endObject();
+}
+
+static std::string errorWithDump()
+{
+    nlohmann::json errorResp;
+    errorResp["status"] = "error";
+    errorResp["message"] = "Unauthorized";
+    return errorResp.dump(4);
+}
+
+template <typename F>
+static double measure(int rounds, F&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++)
+        fn();
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / rounds;
+}
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    srand(12345);
+    Board board = makeBoard();
+
+    size_t sink = 0;
+    std::string reused;
+    reused.reserve(4096);
+    static const std::string preRendered = JsonWriter::errorBody("Unauthorized");
+
+    double dump4 = measure(rounds, [&] { sink += moveWithDump(board, 4).size(); });
+    double dump = measure(rounds, [&] { sink += moveWithDump(board, -1).size(); });
+    double writer = measure(rounds, [&] { moveWithWriter(board, &reused); sink += reused.size(); });
+    double errDump = measure(rounds, [&] { sink += errorWithDump().size(); });
+    double errPre = measure(rounds, [&] { std::string body = preRendered; sink += body.size(); });
+
+    moveWithWriter(board, &reused);
+    bool same = nlohmann::json::parse(reused) == nlohmann::json::parse(moveWithDump(board, 4)) &&
+                nlohmann::json::parse(preRendered) == nlohmann::json::parse(errorWithDump());
+
+    printf("rounds: %d\n", rounds);
+    printf("move  dump(4)      %8.0f ns  %5zu bytes\n", dump4, moveWithDump(board, 4).size());
+    printf("move  dump()       %8.0f ns  %5zu bytes  x%.1f\n", dump, moveWithDump(board, -1).size(), dump4 / dump);
+    printf("move  JsonWriter   %8.0f ns  %5zu bytes  x%.1f\n", writer, reused.size(), dump4 / writer);
+    printf("error dump(4)      %8.0f ns  %5zu bytes\n", errDump, errorWithDump().size());
+    printf("error pre-rendered %8.0f ns  %5zu bytes  x%.1f\n", errPre, preRendered.size(), errDump / errPre);
+    printf("output %s (sink %zu)\n", same ? "ok" : "MISMATCH", sink);
+    return same ? 0 : 1;
+}
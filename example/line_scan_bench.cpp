@@ -0,0 +1,97 @@
+// 连线扫描基准测试：随机生成棋盘，分别用标量、SSE2、AVX2内核做五连判定、成五点搜索和威胁评估
+// 比较三者的耗时，并校验结果一致
+// 编译：cmake -DBUILD_BENCHMARKS=ON .. && make line_scan_bench
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "LineScanner.h"
+
+struct Sample
+{
+    PackedBoard board;
+    alignas(32) uint16_t humanRows[32];
+    alignas(32) uint16_t emptyRows[16];
+};
+
+static std::vector<Sample> makeSamples(int count)
+{
+    std::vector<Sample> samples(count);
+    for (auto& s : samples)
+    {
+        std::memset(s.humanRows, 0, sizeof(s.humanRows));
+        std::memset(s.emptyRows, 0, sizeof(s.emptyRows));
+        int density = rand() % 60; // 棋子占比0% ~ 60%
+        for (int x = 0; x < PackedBoard::kSize; x++)
+        {
+            for (int y = 0; y < PackedBoard::kSize; y++)
+            {
+                int r = rand() % 100;
+                if (r < density)
+                    s.board.place(x, y, r % 2);
+            }
+            uint16_t human = s.board.lines(PackedBoard::kHuman)[PackedBoard::kRowBase + x];
+            uint16_t ai = s.board.lines(PackedBoard::kAi)[PackedBoard::kRowBase + x];
+            s.humanRows[x] = human;
+            s.emptyRows[x] = static_cast<uint16_t>(~(human | ai) & ((1u << PackedBoard::kSize) - 1));
+        }
+    }
+    return samples;
+}
+
+// 跑一遍所有样本，返回耗时（纳秒/局面），结果的校验和写入checksum
+static double run(const LineScanner::Kernels& k, const std::vector<Sample>& samples, int rounds, uint64_t& checksum)
+{
+    alignas(32) uint16_t out[PackedBoard::kLanes];
+    checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++)
+    {
+        for (const auto& s : samples)
+        {
+            checksum += k.hasFive(s.board.lines(PackedBoard::kHuman));
+            k.winningMoves(s.board.lines(PackedBoard::kAi), s.board.lines(PackedBoard::kHuman), out);
+            for (int i = 0; i < PackedBoard::kLanes; i++)
+                checksum = checksum * 31 + out[i];
+            checksum += static_cast<uint64_t>(k.bestThreat(s.humanRows, s.emptyRows));
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (static_cast<double>(rounds) * samples.size());
+}
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? atoi(argv[1]) : 4096;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+    srand(12345);
+    std::vector<Sample> samples = makeSamples(count);
+
+    std::vector<const LineScanner::Kernels*> kernels = {&LineScanner::scalar()};
+    if (LineScanner::sse2())
+        kernels.push_back(LineScanner::sse2());
+    if (LineScanner::avx2())
+        kernels.push_back(LineScanner::avx2());
+
+    printf("boards: %d, rounds: %d, active kernel: %s\n", count, rounds, LineScanner::active().name);
+
+    uint64_t expected = 0;
+    double baseline = 0;
+    bool ok = true;
+    for (size_t i = 0; i < kernels.size(); i++)
+    {
+        uint64_t checksum;
+        double ns = run(*kernels[i], samples, rounds, checksum);
+        if (i == 0)
+        {
+            expected = checksum;
+            baseline = ns;
+        }
+        bool match = checksum == expected;
+        ok = ok && match;
+        printf("%-8s %8.1f ns/board  x%.2f  %s\n", kernels[i]->name, ns, baseline / ns, match ? "ok" : "MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
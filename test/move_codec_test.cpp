@@ -0,0 +1,120 @@
+// 落子响应编码测试：按Accept头和q值协商格式（媒体类型不区分大小写），以及棋盘每格2位的打包顺序
+// 编译运行：cmake -DBUILD_TESTS=ON .. && make move_codec_test && ctest
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "MoveCodec.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do                                                                     \
+    {                                                                      \
+        if (!(cond))                                                       \
+        {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+static void testNegotiate()
+{
+    // 没有声明或者只有通配符时保持JSON
+    CHECK(MoveCodec::negotiate("") == MoveCodec::kJson);
+    CHECK(MoveCodec::negotiate("*/*") == MoveCodec::kJson);
+    CHECK(MoveCodec::negotiate("text/html, */*;q=0.8") == MoveCodec::kJson);
+
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.delta") == MoveCodec::kDelta);
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.board") == MoveCodec::kPackedBoard);
+    // 媒体类型和参数名不区分大小写
+    CHECK(MoveCodec::negotiate("application/vnd.Gomoku.delta") == MoveCodec::kDelta);
+    CHECK(MoveCodec::negotiate("APPLICATION/VND.GOMOKU.BOARD;Q=0.5") == MoveCodec::kPackedBoard);
+
+    // 取q值最高的，同q值按出现顺序
+    CHECK(MoveCodec::negotiate("application/json;q=0.5, application/vnd.gomoku.delta") == MoveCodec::kDelta);
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.delta;q=0.4 , application/vnd.gomoku.board;q=0.9") ==
+          MoveCodec::kPackedBoard);
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.board, application/vnd.gomoku.delta") == MoveCodec::kPackedBoard);
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.delta;q=0.8, application/json") == MoveCodec::kJson);
+    // q=0表示拒绝
+    CHECK(MoveCodec::negotiate("application/vnd.gomoku.delta;q=0") == MoveCodec::kJson);
+}
+
+static void testDelta()
+{
+    MoveCodec::Outcome outcome;
+    outcome.winner = MoveCodec::kNone;
+    outcome.humanNext = true;
+    outcome.lastX = 7;
+    outcome.lastY = 8;
+    std::string out = MoveCodec::encodeDelta(outcome);
+    CHECK(out.size() == MoveCodec::kHeaderSize);
+    CHECK(out == std::string("\x01\x00\x01\x00\x07\x08", 6));
+
+    // 没有AI应手
+    MoveCodec::Outcome over;
+    over.winner = MoveCodec::kHuman;
+    out = MoveCodec::encodeDelta(over);
+    CHECK(out == std::string("\x01\x01\x00\x00\xFF\xFF", 6));
+}
+
+static unsigned cellAt(const std::string &out, int x, int y)
+{
+    int index = x * PackedBoard::kSize + y;
+    unsigned char byte = static_cast<unsigned char>(out[MoveCodec::kHeaderSize + index / 4]);
+    return (byte >> (index % 4 * 2)) & 3u;
+}
+
+static void testPackedBoard()
+{
+    PackedBoard board;
+    board.clear();
+    board.place(0, 0, PackedBoard::kHuman);  // 第0格：字节0的最低2位
+    board.place(0, 1, PackedBoard::kAi);     // 第1格：字节0的第2、3位
+    board.place(0, 3, PackedBoard::kHuman);  // 第3格：字节0的最高2位
+    board.place(1, 0, PackedBoard::kAi);     // 行优先，第15格：字节3的第6、7位
+    board.place(14, 14, PackedBoard::kHuman); // 最后一格：第224格，字节56的最低2位
+
+    MoveCodec::Outcome outcome;
+    outcome.humanNext = true;
+    outcome.lastX = 1;
+    outcome.lastY = 0;
+    std::string out = MoveCodec::encodeBoard(outcome, board);
+
+    CHECK(out.size() == MoveCodec::kHeaderSize + MoveCodec::kBoardBytes);
+    CHECK(MoveCodec::kBoardBytes == 57);
+    CHECK(out[3] == 1); // flags: 附带棋盘
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(out.data() + MoveCodec::kHeaderSize);
+    CHECK(bytes[0] == (1u | 2u << 2 | 1u << 6));
+    CHECK(bytes[3] == 2u << 6);
+    CHECK(bytes[56] == 1u);
+
+    int stones = 0;
+    for (int x = 0; x < PackedBoard::kSize; x++)
+    {
+        for (int y = 0; y < PackedBoard::kSize; y++)
+        {
+            if (cellAt(out, x, y) != 0)
+                stones++;
+        }
+    }
+    CHECK(stones == 5);
+    CHECK(cellAt(out, 1, 0) == 2);
+    CHECK(cellAt(out, 14, 14) == 1);
+}
+
+int main()
+{
+    testNegotiate();
+    testDelta();
+    testPackedBoard();
+    if (failures)
+    {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("move_codec_test passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+// 令牌桶测试：按时间补充令牌、耗尽后返回等待时间，以及多线程下读到的时间早于桶内记录时不会被补满
+// 编译运行：cmake -DBUILD_TESTS=ON .. && make token_bucket_test && ctest
+#include <cstdio>
+#include <cstdlib>
+
+#include "middleware/ratelimit/TokenBucket.h"
+
+using http::middleware::TokenBucket;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do                                                                     \
+    {                                                                      \
+        if (!(cond))                                                       \
+        {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                    \
+        }                                                                  \
+    } while (0)
+
+// 容量5个令牌，每秒1个
+static const uint64_t kCapacity = 5 * 1000;
+static const double kRate = 1.0;
+
+static void testDrainAndRefill()
+{
+    TokenBucket bucket(kCapacity, 1000);
+    for (int i = 0; i < 5; i++)
+        CHECK(bucket.consume(kCapacity, kRate, 1000) == 0);
+    // 耗尽后需要等一整个令牌的时间
+    CHECK(bucket.consume(kCapacity, kRate, 1000) == 1000);
+    CHECK(bucket.consume(kCapacity, kRate, 1400) == 600);
+    CHECK(bucket.consume(kCapacity, kRate, 2000) == 0);
+    CHECK(bucket.consume(kCapacity, kRate, 2000) > 0);
+}
+
+static void testOutOfOrderNow()
+{
+    TokenBucket bucket(kCapacity, 1000);
+    // 另一个线程已经用较晚的时间取走了所有令牌
+    for (int i = 0; i < 5; i++)
+        CHECK(bucket.consume(kCapacity, kRate, 1500) == 0);
+    // 本线程在那之前读到的时间更早，不能被当作经过了约49天而补满
+    CHECK(bucket.consume(kCapacity, kRate, 1200) > 0);
+    CHECK(bucket.tokensMilli() < 1000);
+    // 更早的时间取令牌成功时，桶内记录的时间也不能往回退
+    bucket.consume(kCapacity, kRate, 2500);        // 按1500到2500补充一个令牌并取走
+    CHECK(bucket.consume(kCapacity, kRate, 2000) > 0);
+    CHECK(bucket.consume(kCapacity, kRate, 3500) == 0);
+    CHECK(bucket.consume(kCapacity, kRate, 3500) > 0);
+}
+
+static void testWrapAround()
+{
+    // 32位毫秒时间回绕后仍按正常间隔补充
+    TokenBucket bucket(kCapacity, 0xFFFFFF00LL);
+    for (int i = 0; i < 5; i++)
+        CHECK(bucket.consume(kCapacity, kRate, 0xFFFFFF00LL) == 0);
+    CHECK(bucket.consume(kCapacity, kRate, 0x100000000LL + 744) == 0); // 经过1000毫秒
+    CHECK(bucket.consume(kCapacity, kRate, 0x100000000LL + 744) > 0);
+}
+
+int main()
+{
+    testDrainAndRefill();
+    testOutOfOrderNow();
+    testWrapAround();
+    if (failures)
+    {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("token_bucket_test passed\n");
+    return EXIT_SUCCESS;
+}